@@ -0,0 +1,93 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "binarylistdialog.h"
+#include "ui_binarylistdialog.h"
+#include "utils.h"
+#include <QDebug>
+
+BinaryListDialog::BinaryListDialog(QWidget *parent, OBS *obs, const QString &project, const QString &repository,
+                                   const QString &arch, const QString &package) :
+    QDialog(parent),
+    ui(new Ui::BinaryListDialog),
+    m_obs(obs),
+    m_project(project),
+    m_repository(repository),
+    m_arch(arch),
+    m_package(package)
+{
+    ui->setupUi(this);
+    setWindowTitle(tr("Binaries of %1 (%2/%3)").arg(package, repository, arch));
+    ui->pushButtonDownloadSelected->setEnabled(false);
+    ui->pushButtonDownloadAll->setEnabled(false);
+
+    connect(m_obs, &OBS::finishedParsingBinaryList, this, &BinaryListDialog::addBinaryList);
+    connect(ui->treeBinaries, &QTreeWidget::itemSelectionChanged, this, &BinaryListDialog::toggleDownloadButton);
+    connect(ui->pushButtonDownloadSelected, &QPushButton::clicked, this, &BinaryListDialog::downloadSelected);
+    connect(ui->pushButtonDownloadAll, &QPushButton::clicked, this, &BinaryListDialog::downloadAll);
+
+    m_request = m_obs->getBinaryList(m_project, m_repository, m_arch, m_package);
+}
+
+BinaryListDialog::~BinaryListDialog()
+{
+    m_obs->cancelRequest(m_request);
+    delete ui;
+}
+
+void BinaryListDialog::addBinaryList(const QString &project, const QString &repository, const QString &arch,
+                                     const QString &package, const QList<OBSFile> &binaries)
+{
+    if (project != m_project || repository != m_repository || arch != m_arch || package != m_package) {
+        return;
+    }
+    qDebug() << __PRETTY_FUNCTION__ << binaries.size();
+
+    ui->treeBinaries->clear();
+    for (const OBSFile &binary : binaries) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(ui->treeBinaries);
+        item->setText(0, binary.getName());
+        item->setText(1, Utils::fileSizeHuman(binary.getSize().toFloat()));
+        item->setText(2, Utils::unixTimeToDate(binary.getLastModified()));
+    }
+    ui->treeBinaries->sortByColumn(0, Qt::AscendingOrder);
+    ui->treeBinaries->resizeColumnToContents(0);
+    ui->pushButtonDownloadAll->setEnabled(!binaries.isEmpty());
+}
+
+void BinaryListDialog::toggleDownloadButton()
+{
+    ui->pushButtonDownloadSelected->setEnabled(!ui->treeBinaries->selectedItems().isEmpty());
+}
+
+void BinaryListDialog::downloadSelected()
+{
+    QStringList binaries;
+    for (QTreeWidgetItem *item : ui->treeBinaries->selectedItems()) {
+        binaries.append(item->text(0));
+    }
+    emit downloadBinaries(m_project, m_repository, m_arch, m_package, binaries);
+}
+
+void BinaryListDialog::downloadAll()
+{
+    // An empty list gets every binary
+    emit downloadBinaries(m_project, m_repository, m_arch, m_package, QStringList());
+}
@@ -0,0 +1,62 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BINARYLISTDIALOG_H
+#define BINARYLISTDIALOG_H
+
+#include <QDialog>
+#include "obs.h"
+
+namespace Ui {
+class BinaryListDialog;
+}
+
+class BinaryListDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit BinaryListDialog(QWidget *parent = nullptr, OBS *obs = nullptr,
+                              const QString &project = QString(), const QString &repository = QString(),
+                              const QString &arch = QString(), const QString &package = QString());
+    ~BinaryListDialog();
+
+private:
+    Ui::BinaryListDialog *ui;
+    OBS *m_obs;
+    QString m_project;
+    QString m_repository;
+    QString m_arch;
+    QString m_package;
+    OBSRequestHandle m_request;
+
+private slots:
+    void addBinaryList(const QString &project, const QString &repository, const QString &arch,
+                       const QString &package, const QList<OBSFile> &binaries);
+    void toggleDownloadButton();
+    void downloadSelected();
+    void downloadAll();
+
+signals:
+    void downloadBinaries(const QString &project, const QString &repository, const QString &arch,
+                          const QString &package, const QStringList &binaries);
+};
+
+#endif // BINARYLISTDIALOG_H
@@ -21,11 +21,15 @@
 #include "browser.h"
 #include "ui_browser.h"
 #include <QFileDialog>
+#include <QDir>
+#include <QFileInfo>
+#include <QInputDialog>
 #include <QSettings>
 #include "metaconfigeditor.h"
 #include "createrequestdialog.h"
 #include "packageactiondialog.h"
 #include "buildlogviewer.h"
+#include "binarylistdialog.h"
 
 Browser::Browser(QWidget *parent, OBS *obs) :
     QWidget(parent),
@@ -60,12 +64,36 @@ Browser::Browser(QWidget *parent, OBS *obs) :
     ui->verticalLayout_2->addWidget(m_resultsToolbar);
 
     connect(m_obs, &OBS::finishedParsingProjectList, this, &Browser::addProjectList);
+    connect(m_obs, &OBS::projectListChunkFetched, ui->treeProjects, &ProjectTreeWidget::addProjectListChunk);
 
     connect(m_obs, &OBS::finishedParsingFile, this, &Browser::addFile);
     connect(m_obs, &OBS::finishedParsingFileList, ui->treeFiles, &FileTreeWidget::filesAdded);
     connect(m_obs, &OBS::finishedParsingUploadFileRevision, this, &Browser::slotUploadFile);
     connect(m_obs, &OBS::cannotUploadFile, this, &Browser::slotUploadFileError);
-    connect(m_obs, &OBS::fileFetched, this, &Browser::slotFileFetched);
+    connect(m_obs, &OBS::fileUploadProgress, this, &Browser::slotFileUploadProgress);
+    connect(m_obs, &OBS::commitProgress, this, [this](const QString &project, const QString &package, const QString &message) {
+        QProgressDialog *progressDialog = m_transfers.value(commitTransfer(project, package));
+        if (progressDialog) {
+            progressDialog->setLabelText(message);
+        }
+        emit updateStatusBar(message, false);
+    });
+    connect(m_obs, &OBS::commitFailed, this, &Browser::slotCommitFailed);
+    connect(m_obs, &OBS::nothingToCommit, this, [this](const QString &project, const QString &package) {
+        finishTransfer(commitTransfer(project, package));
+        emit updateStatusBar(tr("Nothing to commit to %1/%2").arg(project, package), true);
+    });
+    connect(m_obs, &OBS::finishedParsingCommitRevision, this, &Browser::slotCommitRevision);
+    connect(m_obs, &OBS::fileUploadFinished, this, &Browser::finishTransfer);
+    OBSDownloadManager *downloadManager = m_obs->getDownloadManager();
+    connect(downloadManager, &OBSDownloadManager::downloadProgress, this, &Browser::slotFileDownloadProgress);
+    connect(downloadManager, &OBSDownloadManager::downloadFinished, this, &Browser::slotFileDownloaded);
+    connect(downloadManager, &OBSDownloadManager::downloadFailed, this, &Browser::slotFileDownloadFailed);
+    connect(m_obs, &OBS::archiveDownloadProgress, this, &Browser::updateTransfer);
+    connect(m_obs, &OBS::archiveDownloaded, this, &Browser::slotArchiveDownloaded);
+    connect(m_obs, &OBS::archiveDownloadFailed, this, &Browser::slotArchiveDownloadFailed);
+    connect(m_obs, &OBS::fileContentsFetched, this, &Browser::slotFileContentsFetched);
+    connect(m_obs, &OBS::fileContentsFailed, this, &Browser::slotFileContentsFailed);
     connect(ui->treeFiles, &FileTreeWidget::updateStatusBar, this, &Browser::updateStatusBar);
 
     connect(m_obs, &OBS::finishedParsingCreateRequest, this, &Browser::slotCreateRequest);
@@ -107,7 +135,9 @@ Browser::Browser(QWidget *parent, OBS *obs) :
     connect(ui->treeBuildResults, &BuildResultTreeWidget::customContextMenuRequested, this,&Browser::slotContextMenuResults);
 
     connect(ui->treeFiles, &FileTreeWidget::droppedFile, this, &Browser::uploadFile);
+    connect(ui->treeFiles, &FileTreeWidget::doubleClicked, this, &Browser::viewFile);
 
+    connect(m_obs, &OBS::packageListChunkFetched, ui->treePackages, &PackageTreeWidget::addPackageListChunk);
     connect(m_obs, &OBS::finishedParsingPackageList, ui->treePackages, &PackageTreeWidget::addPackageList);
     connect(ui->treePackages, &PackageTreeWidget::updateStatusBar, this, &Browser::updateStatusBar);
 
@@ -157,7 +187,8 @@ void Browser::addProjectList(const QStringList &projectList)
     qDebug() << __PRETTY_FUNCTION__;
     ui->treeProjects->addProjectList(projectList);
 
-    emit toggleBookmarkActions("");
+    // A refreshed list keeps the selected project
+    emit toggleBookmarkActions(ui->treeProjects->getCurrentProject());
     emit finishedLoadingProjects();
     emit updateStatusBar(tr("Done"), true);
 }
@@ -343,6 +374,41 @@ void Browser::getBuildLog()
     emit updateStatusBar(tr("Getting build log..."), false);
 }
 
+void Browser::showBinaries()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+    QString currentProject = ui->treeProjects->getCurrentProject();
+    QString currentBuildRepository = ui->treeBuildResults->getCurrentRepository();
+    QString currentBuildArch = ui->treeBuildResults->getCurrentArch();
+    QString currentPackage = ui->treePackages->getCurrentPackage();
+
+    BinaryListDialog *binaryListDialog = new BinaryListDialog(this, m_obs, currentProject, currentBuildRepository,
+                                                              currentBuildArch, currentPackage);
+    binaryListDialog->setAttribute(Qt::WA_DeleteOnClose, true);
+    connect(binaryListDialog, &BinaryListDialog::downloadBinaries, this, &Browser::downloadBinaries);
+    binaryListDialog->show();
+}
+
+void Browser::downloadBinaries(const QString &project, const QString &repository, const QString &arch,
+                               const QString &package, const QStringList &binaries)
+{
+    QString parentDirectory = QFileDialog::getExistingDirectory(this, tr("Download binaries to"));
+    if (parentDirectory.isEmpty()) {
+        return;
+    }
+    QString directory = QDir(parentDirectory).filePath(QString("%1-%2").arg(repository, arch));
+    if (m_transfers.contains(directory)) {
+        return;
+    }
+
+    // All the binaries in one request
+    OBSRequestHandle handle = m_obs->downloadBinaries(project, repository, arch, package, binaries, directory);
+    addTransfer(directory, tr("Download"), tr("Downloading binaries of %1...").arg(package), [this, handle]() {
+        m_obs->cancelRequest(handle);
+    });
+    emit updateStatusBar(tr("Downloading binaries of %1 (%2/%3)...").arg(package, repository, arch), false);
+}
+
 void Browser::branchSelectedPackage()
 {
     QString project = ui->treeProjects->getCurrentProject();
@@ -393,13 +459,198 @@ void Browser::downloadFile()
     QString currentProject = ui->treeProjects->getCurrentProject();
     QString currentPackage = ui->treePackages->getCurrentPackage();
     QString currentFile = ui->treeFiles->getCurrentFile();
-    m_obs->downloadFile(currentProject, currentPackage, currentFile);
+
+    QString path = QFileDialog::getSaveFileName(this, tr("Save as"), currentFile);
+    if (path.isEmpty() || m_transfers.contains(path)) {
+        return;
+    }
+
+    // Queued, and resumed if the connection drops
+    OBSDownloadManager *downloadManager = m_obs->getDownloadManager();
+    int id = downloadManager->enqueue(currentProject, currentPackage, currentFile, path,
+                                      ui->treeFiles->getCurrentFileMd5());
+    addTransfer(path, tr("Download"), tr("Downloading %1...").arg(currentFile), [downloadManager, id]() {
+        downloadManager->remove(id);
+    });
+}
+
+void Browser::viewFile()
+{
+    // Bigger files are most likely tarballs
+    const qint64 maxViewSize = 5 * 1024 * 1024;
+
+    QString currentProject = ui->treeProjects->getCurrentProject();
+    QString currentPackage = ui->treePackages->getCurrentPackage();
+    QString currentFile = ui->treeFiles->getCurrentFile();
+    if (ui->treeFiles->getCurrentFileSize() > maxViewSize) {
+        emit updateStatusBar(tr("%1 is too big to be shown, download it instead").arg(currentFile), true);
+        return;
+    }
+
+    // Served from the blob store if the md5 is already known
+    m_obs->getFileContents(currentProject, currentPackage, currentFile, ui->treeFiles->getCurrentFileMd5());
+    emit updateStatusBar(tr("Getting %1...").arg(currentFile), false);
+}
+
+void Browser::downloadPackage()
+{
+    QString currentProject = ui->treeProjects->getCurrentProject();
+    QString currentPackage = ui->treePackages->getCurrentPackage();
+
+    QString parentDirectory = QFileDialog::getExistingDirectory(this, tr("Download package to"));
+    if (parentDirectory.isEmpty()) {
+        return;
+    }
+    QString directory = QDir(parentDirectory).filePath(currentPackage);
+    if (m_transfers.contains(directory)) {
+        return;
+    }
+
+    // All the files in one request
+    OBSRequestHandle handle = m_obs->downloadPackage(currentProject, currentPackage, directory);
+    addTransfer(directory, tr("Download"), tr("Downloading %1...").arg(currentPackage), [this, handle]() {
+        m_obs->cancelRequest(handle);
+    });
+    emit updateStatusBar(tr("Downloading %1/%2...").arg(currentProject, currentPackage), false);
+}
+
+void Browser::checkoutPackage()
+{
+    QString currentProject = ui->treeProjects->getCurrentProject();
+    QString currentPackage = ui->treePackages->getCurrentPackage();
+
+    QString parentDirectory = QFileDialog::getExistingDirectory(this, tr("Check out package to"));
+    if (parentDirectory.isEmpty()) {
+        return;
+    }
+    QString directory = QDir(parentDirectory).filePath(currentPackage);
+    if (m_transfers.contains(directory)) {
+        return;
+    }
+
+    OBSWorkingCopy *workingCopy = new OBSWorkingCopy(directory, this);
+    startWorkingCopy(workingCopy, OBSWorkingCopy::Checkout);
+    workingCopy->checkout(currentProject, currentPackage);
+}
+
+void Browser::updateWorkingCopy()
+{
+    QString directory = QFileDialog::getExistingDirectory(this, tr("Update working copy"));
+    if (directory.isEmpty() || m_transfers.contains(directory)) {
+        return;
+    }
+
+    OBSWorkingCopy *workingCopy = new OBSWorkingCopy(directory, this);
+    startWorkingCopy(workingCopy, OBSWorkingCopy::Update);
+    workingCopy->update();
+}
+
+void Browser::commitWorkingCopy()
+{
+    QString directory = QFileDialog::getExistingDirectory(this, tr("Commit working copy"));
+    if (directory.isEmpty() || m_transfers.contains(directory)) {
+        return;
+    }
+
+    bool ok;
+    QString comment = QInputDialog::getText(this, tr("Commit"), tr("Commit message:"),
+                                            QLineEdit::Normal, QString(), &ok);
+    if (!ok) {
+        return;
+    }
+
+    OBSWorkingCopy *workingCopy = new OBSWorkingCopy(directory, this);
+    startWorkingCopy(workingCopy, OBSWorkingCopy::Commit);
+    workingCopy->commit(comment);
+}
+
+void Browser::startWorkingCopy(OBSWorkingCopy *workingCopy, OBSWorkingCopy::Operation operation)
+{
+    QString directory = workingCopy->getDirectory();
+    QString title = operation == OBSWorkingCopy::Checkout ? tr("Checkout") :
+                    operation == OBSWorkingCopy::Update ? tr("Update") : tr("Commit");
+    addTransfer(directory, title, tr("%1 of %2...").arg(title, directory), [this, workingCopy]() {
+        disconnect(workingCopy, nullptr, this, nullptr);
+        workingCopy->cancel();
+        workingCopy->deleteLater();
+    });
+
+    connect(workingCopy, &OBSWorkingCopy::progress, this, [this, directory](const QString &message) {
+        QProgressDialog *progressDialog = m_transfers.value(directory);
+        if (progressDialog) {
+            progressDialog->setLabelText(message);
+        }
+        emit updateStatusBar(message, false);
+    });
+    connect(workingCopy, &OBSWorkingCopy::finished, this, [this, workingCopy, directory](const QString &message) {
+        qDebug() << __PRETTY_FUNCTION__ << message;
+        finishTransfer(directory);
+        if (workingCopy->getProject() == ui->treeProjects->getCurrentProject() &&
+                workingCopy->getPackage() == ui->treePackages->getCurrentPackage()) {
+            getPackageFiles(workingCopy->getPackage());
+        }
+        emit updateStatusBar(message, true);
+        workingCopy->deleteLater();
+    });
+    connect(workingCopy, &OBSWorkingCopy::failed, this, [this, workingCopy, directory, title, operation](const QString &errorString) {
+        qDebug() << __PRETTY_FUNCTION__ << errorString;
+        finishTransfer(directory);
+        // Commit errors from the server are shown by slotCommitFailed()
+        if (operation != OBSWorkingCopy::Commit) {
+            QMessageBox::warning(this, tr("Warning"), tr("%1 of %2 failed").arg(title, directory) + "<br>" + errorString);
+        }
+        emit updateStatusBar(tr("%1 failed: %2").arg(title, errorString), true);
+        workingCopy->deleteLater();
+    });
+}
+
+void Browser::addTransfer(const QString &path, const QString &title, const QString &label, const std::function<void()> &cancel)
+{
+    QProgressDialog *progressDialog = new QProgressDialog(label, tr("Cancel"), 0, 0, this);
+    progressDialog->setWindowTitle(title);
+    progressDialog->setAttribute(Qt::WA_DeleteOnClose, true);
+    progressDialog->setMinimumDuration(500);
+    connect(progressDialog, &QProgressDialog::canceled, this, [this, cancel, path, title]() {
+        cancel();
+        finishTransfer(path);
+        emit updateStatusBar(tr("%1 cancelled").arg(title), true);
+    });
+    m_transfers.insert(path, progressDialog);
+}
+
+void Browser::updateTransfer(const QString &path, qint64 bytes, qint64 bytesTotal)
+{
+    QProgressDialog *progressDialog = m_transfers.value(path);
+    if (!progressDialog) {
+        return;
+    }
+    // The range is in KiB, as QProgressDialog takes ints
+    if (bytesTotal > 0) {
+        progressDialog->setMaximum(int(bytesTotal / 1024));
+    }
+    progressDialog->setValue(int(bytes / 1024));
+}
+
+void Browser::finishTransfer(const QString &path)
+{
+    QProgressDialog *progressDialog = m_transfers.take(path);
+    if (progressDialog) {
+        // Closing the dialog emits canceled()
+        disconnect(progressDialog, &QProgressDialog::canceled, this, nullptr);
+        progressDialog->close();
+    }
 }
 
 void Browser::uploadSelectedFile()
 {
     QStringList pathList = QFileDialog::getOpenFileNames(this, tr("Upload file"));
 
+    // Several files go in a single revision
+    if (pathList.size() > 1) {
+        commitFiles(pathList);
+        return;
+    }
+
     foreach (QString path, pathList) {
         qDebug() << __PRETTY_FUNCTION__  << "path:" << path;
         uploadFile(path);
@@ -423,6 +674,8 @@ void Browser::createRequest()
 
     CreateRequestDialog *createRequestDialog = new CreateRequestDialog(request, m_obs, this);
     createRequestDialog->addProjectList(ui->treeProjects->getProjectList());
+    disconnect(m_obs, &OBS::packageListChunkFetched,
+               ui->treePackages, &PackageTreeWidget::addPackageListChunk);
     disconnect(m_obs, &OBS::finishedParsingPackageList,
                ui->treePackages, &PackageTreeWidget::addPackageList);
 
@@ -434,6 +687,8 @@ void Browser::createRequest()
     delete createRequestDialog;
     delete request;
 
+    connect(m_obs, &OBS::packageListChunkFetched,
+            ui->treePackages, &PackageTreeWidget::addPackageListChunk);
     connect(m_obs, &OBS::finishedParsingPackageList,
             ui->treePackages, &PackageTreeWidget::addPackageList);
 }
@@ -567,6 +822,9 @@ void Browser::slotProjectSelectionChanged(const QItemSelection &selected, const
     QString selectedProjectStr;
 
     // Clean up packages, files and build results on project click
+    m_obs->cancelRequest(m_packagesRequest);
+    cancelPackageRequests();
+    ui->treePackages->setProject(QString());
     ui->treePackages->clearModel();
     ui->treeFiles->clearModel();
     ui->treeBuildResults->clearModel();
@@ -594,12 +852,24 @@ void Browser::slotContextMenuPackages(const QPoint &point)
 void Browser::getPackages(const QString &project)
 {
     qDebug() << __PRETTY_FUNCTION__ << project;
+    // Supersedes the package list being fetched, if any
+    m_obs->cancelRequest(m_packagesRequest);
+    ui->treePackages->setProject(project);
+
     if (!project.isEmpty()) {
         emit updateStatusBar(tr("Getting packages..."), false);
-        m_obs->getPackages(project);
+        m_packagesRequest = m_obs->getPackages(project);
     }
 }
 
+void Browser::cancelPackageRequests()
+{
+    m_obs->cancelRequest(m_filesRequest);
+    m_obs->cancelRequest(m_resultsRequest);
+    m_filesRequest = OBSRequestHandle();
+    m_resultsRequest = OBSRequestHandle();
+}
+
 void Browser::slotPackageSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected)
 {
     qDebug() << __PRETTY_FUNCTION__;
@@ -616,6 +886,7 @@ void Browser::slotPackageSelectionChanged(const QItemSelection &selected, const
         ui->treeFiles->setAcceptDrops(true);
     } else {
         // If there is no package selected, clear both the file and build result lists
+        cancelPackageRequests();
         ui->treeFiles->clearModel();
         ui->treeBuildResults->clearModel();
 
@@ -632,7 +903,8 @@ void Browser::getPackageFiles(const QString &package)
     ui->treeFiles->clearModel();
 
     QString currentProject = ui->treeProjects->getCurrentProject();
-    m_obs->getFiles(currentProject, package);
+    m_obs->cancelRequest(m_filesRequest);
+    m_filesRequest = m_obs->getFiles(currentProject, package);
     emit updateStatusBar(tr("Getting package data..."), false);
 }
 
@@ -642,7 +914,8 @@ void Browser::getBuildResults(const QString &project, const QString &package)
     emit updateStatusBar(tr("Getting build results..."), false);
 
     ui->treeBuildResults->clearModel();
-    m_obs->getAllBuildStatus(project, package);
+    m_obs->cancelRequest(m_resultsRequest);
+    m_resultsRequest = m_obs->getAllBuildStatus(project, package);
 }
 
 void Browser::slotContextMenuFiles(const QPoint &point)
@@ -677,18 +950,18 @@ void Browser::uploadFile(const QString &path)
     QString package = ui->treePackages->getCurrentPackage();
 
     if (!project.isEmpty() && !package.isEmpty()) {
-        QFile file(path);
-        if (!file.open(QIODevice::ReadOnly)) {
+        if (m_transfers.contains(path)) {
             return;
         }
 
-        QByteArray data = file.readAll();
-        qDebug() << __PRETTY_FUNCTION__ << "data.size()" << data.size();
-
-        QFileInfo fi(file.fileName());
+        // The file is streamed from disk
+        QFileInfo fi(path);
         QString fileName = fi.fileName();
 
-        m_obs->uploadFile(project, package, fileName, data);
+        OBSRequestHandle handle = m_obs->uploadFile(project, package, fileName, path);
+        addTransfer(path, tr("Upload"), tr("Uploading %1 to %2/%3...").arg(fileName, project, package), [this, handle]() {
+            m_obs->cancelRequest(handle);
+        });
 
         QString statusText = tr("Uploading %1 to %2/%3...").arg(fileName, project, package);
         emit updateStatusBar(statusText, false);
@@ -697,6 +970,70 @@ void Browser::uploadFile(const QString &path)
     }
 }
 
+void Browser::commitFiles(const QStringList &paths)
+{
+    qDebug() << __PRETTY_FUNCTION__ << paths;
+    QString project = ui->treeProjects->getCurrentProject();
+    QString package = ui->treePackages->getCurrentPackage();
+    if (project.isEmpty() || package.isEmpty()) {
+        return;
+    }
+
+    bool ok;
+    QString comment = QInputDialog::getText(this, tr("Commit"), tr("Commit message:"),
+                                            QLineEdit::Normal, QString(), &ok);
+    if (!ok) {
+        return;
+    }
+
+    QString transfer = commitTransfer(project, package);
+    if (m_transfers.contains(transfer)) {
+        return;
+    }
+
+    QString statusText = tr("Committing %1 files to %2/%3...").arg(paths.size()).arg(project, package);
+    OBSRequestHandle handle = m_obs->commitFiles(project, package, paths, comment);
+    addTransfer(transfer, tr("Commit"), statusText, [this, handle]() {
+        m_obs->cancelRequest(handle);
+    });
+    emit updateStatusBar(statusText, false);
+}
+
+QString Browser::commitTransfer(const QString &project, const QString &package) const
+{
+    // Transfers are keyed by path, a commit by the package it goes to
+    return QString("commit:%1/%2").arg(project, package);
+}
+
+void Browser::slotCommitRevision(OBSRevision *revision)
+{
+    qDebug() << __PRETTY_FUNCTION__ << revision->getRev();
+    finishTransfer(commitTransfer(revision->getProject(), revision->getPackage()));
+    QString currentProject = ui->treeProjects->getCurrentProject();
+    QString currentPackage = ui->treePackages->getCurrentPackage();
+
+    if (currentProject == revision->getProject() && currentPackage == revision->getPackage()) {
+        getPackageFiles(currentPackage);
+    }
+    showTrayMessage(APP_NAME, tr("Revision %1 of %2/%3 has been committed")
+                    .arg(revision->getRev()).arg(revision->getProject(), revision->getPackage()));
+
+    delete revision;
+    revision = nullptr;
+
+    emit updateStatusBar(tr("Done"), true);
+}
+
+void Browser::slotCommitFailed(const QString &project, const QString &package, const QString &errorString)
+{
+    qDebug() << __PRETTY_FUNCTION__ << project << package << errorString;
+    finishTransfer(commitTransfer(project, package));
+    QString title = tr("Warning");
+    QString text = tr("Cannot commit to %1/%2").arg(project, package) + "<br>" + errorString;
+    QMessageBox::warning(this, title, text);
+    emit updateStatusBar(tr("Error committing to %1/%2").arg(project, package), true);
+}
+
 void Browser::slotUploadFile(OBSRevision *revision)
 {
     qDebug() << __PRETTY_FUNCTION__;
@@ -784,20 +1121,89 @@ void Browser::slotBranchPackage(OBSStatus *status)
     emit updateStatusBar(tr("Done"), true);
 }
 
-void Browser::slotFileFetched(const QString &fileName, const QByteArray &data)
+void Browser::slotFileUploadProgress(const QString &path, qint64 bytesSent, qint64 bytesTotal)
 {
-    QString path = QFileDialog::getSaveFileName(this, tr("Save as"), fileName);
-    QFile file(path);
+    updateTransfer(path, bytesSent, bytesTotal);
+    if (bytesTotal > 0) {
+        QString statusText = tr("Uploading %1... %2%").arg(QFileInfo(path).fileName())
+                .arg(bytesSent * 100 / bytesTotal);
+        emit updateStatusBar(statusText, false);
+    }
+}
 
-    file.open(QIODevice::WriteOnly);
-    qint64 bytesWritten = file.write(data);
-    file.close();
+void Browser::slotFileDownloadProgress(int id, qint64 bytesReceived, qint64 bytesTotal)
+{
+    QString path = m_obs->getDownloadManager()->getDownload(id).path;
+    updateTransfer(path, bytesReceived, bytesTotal);
+}
+
+void Browser::slotFileDownloaded(int id)
+{
+    QString path = m_obs->getDownloadManager()->getDownload(id).path;
+    finishTransfer(path);
+    QString fileName = QFileInfo(path).fileName();
+    showTrayMessage(APP_NAME, tr("File %1 downloaded successfuly").arg(fileName));
+}
 
-    if (bytesWritten!=-1) {
-        showTrayMessage(APP_NAME, tr("File %1 downloaded successfuly").arg(fileName));
+void Browser::slotFileDownloadFailed(int id, const QString &errorString)
+{
+    OBSDownloadManager *downloadManager = m_obs->getDownloadManager();
+    QString path = downloadManager->getDownload(id).path;
+    qDebug() << __PRETTY_FUNCTION__ << path << errorString;
+    finishTransfer(path);
+
+    const QString title = tr("Download failed");
+    const QString text = QString("<b>%1</b><br>%2").arg(QFileInfo(path).fileName(), errorString);
+    QMessageBox::StandardButton result = QMessageBox::warning(this, title, text,
+                                                              QMessageBox::Retry | QMessageBox::Discard,
+                                                              QMessageBox::Discard);
+    if (result == QMessageBox::Retry) {
+        downloadManager->resume(id);
+    } else {
+        downloadManager->remove(id);
     }
 }
 
+void Browser::slotFileContentsFetched(const QString &project, const QString &package, const QString &fileName,
+                                      const QByteArray &data)
+{
+    qDebug() << __PRETTY_FUNCTION__ << project << package << fileName;
+    BuildLogViewer *fileViewer = new BuildLogViewer(this);
+    fileViewer->setWindowTitle(QString("%1/%2/%3").arg(project, package, fileName));
+    fileViewer->setAttribute(Qt::WA_DeleteOnClose, true);
+    fileViewer->show();
+    fileViewer->setText(QString::fromUtf8(data), false);
+    emit updateStatusBar(tr("Done"), true);
+}
+
+void Browser::slotFileContentsFailed(const QString &project, const QString &package, const QString &fileName,
+                                     const QString &errorString)
+{
+    qDebug() << __PRETTY_FUNCTION__ << project << package << fileName << errorString;
+    const QString title = tr("Warning");
+    const QString text = QString("<b>%1</b><br>%2").arg(fileName, errorString);
+    QMessageBox::warning(this, title, text);
+    emit updateStatusBar(tr("Error getting %1").arg(fileName), true);
+}
+
+void Browser::slotArchiveDownloaded(const QString &directory, const QStringList &files)
+{
+    qDebug() << __PRETTY_FUNCTION__ << directory << files.size();
+    finishTransfer(directory);
+    showTrayMessage(APP_NAME, tr("%1 files downloaded to %2").arg(files.size()).arg(directory));
+    emit updateStatusBar(tr("Done"), true);
+}
+
+void Browser::slotArchiveDownloadFailed(const QString &directory, const QString &errorString)
+{
+    qDebug() << __PRETTY_FUNCTION__ << directory << errorString;
+    finishTransfer(directory);
+    const QString title = tr("Download failed");
+    const QString text = QString("<b>%1</b><br>%2").arg(directory, errorString);
+    QMessageBox::warning(this, title, text);
+    emit updateStatusBar(tr("Download failed"), true);
+}
+
 void Browser::slotBuildLogFetched(const QString &buildLog)
 {
     qDebug() << __PRETTY_FUNCTION__;
@@ -25,7 +25,9 @@
 #include <QItemSelectionModel>
 #include <QMenu>
 #include <QToolBar>
+#include <QProgressDialog>
 #include "obs.h"
+#include "obsworkingcopy.h"
 
 namespace Ui {
 class Browser;
@@ -62,12 +64,18 @@ public slots:
     void addResult(OBSResult *result);
     void reloadResults();
     void getBuildLog();
+    void showBinaries();
     void branchSelectedPackage();
     void getProjects();
     void goHome();
     QString getCurrentProject() const;
     void setCurrentProject(const QString &project);
     void downloadFile();
+    void viewFile();
+    void downloadPackage();
+    void checkoutPackage();
+    void updateWorkingCopy();
+    void commitWorkingCopy();
     void uploadSelectedFile();
     void createRequest();
     void linkPackage();
@@ -91,6 +99,16 @@ private:
     QToolBar *m_packagesToolbar;
     QToolBar *m_filesToolbar;
     QToolBar *m_resultsToolbar;
+    OBSRequestHandle m_packagesRequest;
+    OBSRequestHandle m_filesRequest;
+    OBSRequestHandle m_resultsRequest;
+    void cancelPackageRequests();
+    QHash<QString, QProgressDialog *> m_transfers;
+    void addTransfer(const QString &path, const QString &title, const QString &label, const std::function<void()> &cancel);
+    void updateTransfer(const QString &path, qint64 bytes, qint64 bytesTotal);
+    void finishTransfer(const QString &path);
+    QString commitTransfer(const QString &project, const QString &package) const;
+    void startWorkingCopy(OBSWorkingCopy *workingCopy, OBSWorkingCopy::Operation operation);
     void writeSettings();
     void setupModels();
     void getPackages(const QString &project);
@@ -102,9 +120,14 @@ private slots:
     void slotPackageSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected);
     void getPackageFiles(const QString &package);
     void getBuildResults(const QString &project, const QString &package);
+    void downloadBinaries(const QString &project, const QString &repository, const QString &arch,
+                          const QString &package, const QStringList &binaries);
     void slotContextMenuFiles(const QPoint &point);
     void addFile(OBSFile *file);
     void uploadFile(const QString &path);
+    void commitFiles(const QStringList &paths);
+    void slotCommitRevision(OBSRevision *revision);
+    void slotCommitFailed(const QString &project, const QString &package, const QString &errorString);
     void slotUploadFile(OBSRevision *revision);
     void slotUploadFileError(OBSStatus *status);
     void finishedAddingResults();
@@ -112,7 +135,16 @@ private slots:
     void slotCreateRequest(OBSRequest *request);
     void slotCreateRequestStatus(OBSStatus *status);
     void slotBranchPackage(OBSStatus *status);
-    void slotFileFetched(const QString &fileName, const QByteArray &data);
+    void slotFileUploadProgress(const QString &path, qint64 bytesSent, qint64 bytesTotal);
+    void slotFileDownloadProgress(int id, qint64 bytesReceived, qint64 bytesTotal);
+    void slotFileDownloaded(int id);
+    void slotFileDownloadFailed(int id, const QString &errorString);
+    void slotFileContentsFetched(const QString &project, const QString &package, const QString &fileName,
+                                 const QByteArray &data);
+    void slotFileContentsFailed(const QString &project, const QString &package, const QString &fileName,
+                                const QString &errorString);
+    void slotArchiveDownloaded(const QString &directory, const QStringList &files);
+    void slotArchiveDownloadFailed(const QString &directory, const QString &errorString);
     void slotBuildLogFetched(const QString &buildLog);
     void slotBuildLogNotFound();
     void slotProjectNotFound(OBSStatus *status);
@@ -39,10 +39,12 @@ BuildLogViewer::~BuildLogViewer()
     delete ui;
 }
 
-void BuildLogViewer::setText(const QString &text)
+void BuildLogViewer::setText(const QString &text, bool scrollToEnd)
 {
     ui->plainTextEdit->setPlainText(text);
-    scrollToBottom();
+    if (scrollToEnd) {
+        scrollToBottom();
+    }
 }
 
 void BuildLogViewer::scrollToBottom()
@@ -38,7 +38,7 @@ public:
     explicit BuildLogViewer(QWidget *parent = nullptr);
     ~BuildLogViewer();
 
-    void setText(const QString &text);
+    void setText(const QString &text, bool scrollToEnd = true);
 
 private:
     Ui::BuildLogViewer *ui;
@@ -106,6 +106,7 @@ void FileTreeWidget::addFile(OBSFile *obsFile)
         QStandardItem *itemName = new QStandardItem();
         itemName->setData(obsFile->getName(), Qt::UserRole);
         itemName->setData(obsFile->getName(), Qt::DisplayRole);
+        itemName->setData(obsFile->getMd5(), Md5Role);
 
         // Size
         QStandardItem *itemSize = new QStandardItem();
@@ -156,6 +157,18 @@ QString FileTreeWidget::getCurrentFile() const
     return indexList.at(0).data().toString();
 }
 
+QString FileTreeWidget::getCurrentFileMd5() const
+{
+    QModelIndexList indexList = selectionModel()->selectedIndexes();
+    return indexList.at(0).data(Md5Role).toString();
+}
+
+qint64 FileTreeWidget::getCurrentFileSize() const
+{
+    QModelIndexList indexList = selectionModel()->selectedIndexes();
+    return indexList.at(0).sibling(indexList.at(0).row(), 1).data(Qt::UserRole).toLongLong();
+}
+
 bool FileTreeWidget::removeFile(const QString &fileName)
 {
     QModelIndexList itemList = model()->match(model()->index(0, 0),
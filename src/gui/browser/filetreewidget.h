@@ -41,6 +41,8 @@ public:
     void addFile(OBSFile *obsFile);
     bool hasLink() const;
     QString getCurrentFile() const;
+    QString getCurrentFileMd5() const;
+    qint64 getCurrentFileSize() const;
     bool removeFile(const QString &fileName);
     void clearModel();
 
@@ -50,6 +52,7 @@ protected:
     void dropEvent(QDropEvent *event);
 
 private:
+    static const int Md5Role = Qt::UserRole + 1;
     QStandardItemModel *sourceModelFiles;
     bool firstTimeFileListDisplayed;
     int m_logicalIndex;
@@ -79,6 +79,18 @@ void PackageListModel::addPackageList(const QStringList &packages)
     endResetModel();
 }
 
+void PackageListModel::appendPackages(const QStringList &packages)
+{
+    if (packages.isEmpty()) {
+        return;
+    }
+
+    int index = m_packages.count();
+    beginInsertRows(QModelIndex(), index, index + packages.count() - 1);
+    m_packages.append(packages);
+    endInsertRows();
+}
+
 bool PackageListModel::removePackage(const QString &package)
 {
     int index = m_packages.indexOf(package);
@@ -34,6 +34,7 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     void addPackage(const QString &package);
     void addPackageList(const QStringList &packages);
+    void appendPackages(const QStringList &packages);
     bool removePackage(const QString &package);
     QStringList stringList() const;
 
@@ -24,7 +24,8 @@
 PackageTreeWidget::PackageTreeWidget(QWidget *parent) :
     QTreeView(parent),
     sourceModelPackages(new PackageListModel(this)),
-    proxyModelPackages(new QSortFilterProxyModel(this))
+    proxyModelPackages(new QSortFilterProxyModel(this)),
+    m_streamed(false)
 {
     setContextMenuPolicy(Qt::CustomContextMenu);
     createModel();
@@ -49,17 +50,44 @@ void PackageTreeWidget::addPackage(const QString &package)
     sourceModelPackages->addPackage(package);
 }
 
-void PackageTreeWidget::addPackageList(const QStringList &packageList)
+void PackageTreeWidget::addPackageList(const QStringList &packageList, const QString &project)
 {
-    qDebug() << __PRETTY_FUNCTION__;
-    selectionModel()->clear(); // Emits selectionChanged() and currentChanged()
-    sourceModelPackages->addPackageList(packageList);
-    proxyModelPackages->setSourceModel(sourceModelPackages);
-    setModel(proxyModelPackages);
+    qDebug() << __PRETTY_FUNCTION__ << project;
+    // Late list of a project we have navigated away from
+    if (project != m_project) {
+        return;
+    }
+
+    // Nothing to do if the chunks have shown it already
+    bool streamed = m_streamed;
+    m_streamed = false;
+    if (!streamed || sourceModelPackages->stringList() != packageList) {
+        selectionModel()->clear(); // Emits selectionChanged() and currentChanged()
+        sourceModelPackages->addPackageList(packageList);
+        proxyModelPackages->setSourceModel(sourceModelPackages);
+        setModel(proxyModelPackages);
+    }
 
     emit updateStatusBar(tr("Done"), true);
 }
 
+void PackageTreeWidget::addPackageListChunk(const QStringList &packages, const QString &project, bool first)
+{
+    if (project != m_project) {
+        return;
+    }
+
+    if (first) {
+        selectionModel()->clear(); // Emits selectionChanged() and currentChanged()
+        sourceModelPackages->addPackageList(packages);
+        proxyModelPackages->setSourceModel(sourceModelPackages);
+        setModel(proxyModelPackages);
+    } else {
+        sourceModelPackages->appendPackages(packages);
+    }
+    m_streamed = true;
+}
+
 QStringList PackageTreeWidget::getPackageList() const
 {
     return sourceModelPackages->stringList();
@@ -96,6 +124,16 @@ bool PackageTreeWidget::removePackage(const QString &package)
     return sourceModelPackages->removePackage(package);
 }
 
+QString PackageTreeWidget::getProject() const
+{
+    return m_project;
+}
+
+void PackageTreeWidget::setProject(const QString &project)
+{
+    m_project = project;
+}
+
 void PackageTreeWidget::clearModel()
 {
     model()->removeRows(0, model()->rowCount());
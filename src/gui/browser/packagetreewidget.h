@@ -38,16 +38,21 @@ public:
     QString getCurrentPackage() const;
     bool removePackage(const QString &package);
     void clearModel();
+    QString getProject() const;
+    void setProject(const QString &project);
 
 public slots:
     void addPackage(const QString &package);
-    void addPackageList(const QStringList &packageList);
+    void addPackageList(const QStringList &packageList, const QString &project);
+    void addPackageListChunk(const QStringList &packages, const QString &project, bool first);
     bool setCurrentPackage(const QString &package);
     void filterPackages(const QString &item);
 
 private:
     PackageListModel *sourceModelPackages;
     QSortFilterProxyModel *proxyModelPackages;
+    QString m_project;
+    bool m_streamed;
 
 signals:
     void updateStatusBar(QString message, bool progressBarHidden);
@@ -79,6 +79,59 @@ void ProjectListModel::addProjectList(const QStringList &projects)
     endResetModel();
 }
 
+void ProjectListModel::appendProjects(const QStringList &projects)
+{
+    if (projects.isEmpty()) {
+        return;
+    }
+
+    int index = m_projects.count();
+    beginInsertRows(QModelIndex(), index, index + projects.count() - 1);
+    m_projects.append(projects);
+    endInsertRows();
+}
+
+void ProjectListModel::updateProjectList(const QStringList &projects)
+{
+    // Both lists are sorted, so they are merged with a few runs of removed
+    // and inserted rows. The rows that are kept keep their selection.
+    int row = 0;
+    int next = 0;
+    while (next < projects.count()) {
+        if (row < m_projects.count() && m_projects.at(row) == projects.at(next)) {
+            row++;
+            next++;
+        } else if (row < m_projects.count() && m_projects.at(row) < projects.at(next)) {
+            int last = row;
+            while (last + 1 < m_projects.count() && m_projects.at(last + 1) < projects.at(next)) {
+                last++;
+            }
+            beginRemoveRows(QModelIndex(), row, last);
+            m_projects.erase(m_projects.begin() + row, m_projects.begin() + last + 1);
+            endRemoveRows();
+        } else {
+            int end = next + 1;
+            while (end < projects.count() &&
+                   (row >= m_projects.count() || projects.at(end) < m_projects.at(row))) {
+                end++;
+            }
+            beginInsertRows(QModelIndex(), row, row + end - next - 1);
+            for (int i = next; i < end; i++) {
+                m_projects.insert(row + i - next, projects.at(i));
+            }
+            endInsertRows();
+            row += end - next;
+            next = end;
+        }
+    }
+
+    if (row < m_projects.count()) {
+        beginRemoveRows(QModelIndex(), row, m_projects.count() - 1);
+        m_projects.erase(m_projects.begin() + row, m_projects.end());
+        endRemoveRows();
+    }
+}
+
 bool ProjectListModel::removeProject(const QString &project)
 {
     int index = m_projects.indexOf(project);
@@ -34,6 +34,8 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     void addProject(const QString &project);
     void addProjectList(const QStringList &projects);
+    void appendProjects(const QStringList &projects);
+    void updateProjectList(const QStringList &projects);
     bool removeProject(const QString &project);
     QStringList stringList() const;
 
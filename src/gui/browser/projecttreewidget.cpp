@@ -23,7 +23,9 @@
 ProjectTreeWidget::ProjectTreeWidget(QWidget *parent) :
     QTreeView(parent),
     sourceModelProjects(new ProjectListModel(this)),
-    proxyModelProjects(new QSortFilterProxyModel(this))
+    proxyModelProjects(new QSortFilterProxyModel(this)),
+    m_streamed(false),
+    m_refreshing(false)
 {
     setContextMenuPolicy(Qt::CustomContextMenu);
     proxyModelProjects->setSourceModel(sourceModelProjects);
@@ -55,6 +57,42 @@ bool ProjectTreeWidget::setCurrentProject(const QString &project)
 }
 
 void ProjectTreeWidget::addProjectList(const QStringList &projectList)
+{
+    // Nothing to do if the chunks have shown it already
+    bool streamed = m_streamed;
+    m_streamed = false;
+    m_refreshing = false;
+    if (streamed && sourceModelProjects->stringList() == projectList) {
+        return;
+    }
+
+    // A refresh of the list shown (e.g. the cached one) keeps the selection
+    if (sourceModelProjects->stringList().isEmpty()) {
+        resetProjectList(projectList);
+    } else {
+        sourceModelProjects->updateProjectList(projectList);
+    }
+}
+
+void ProjectTreeWidget::addProjectListChunk(const QStringList &projects, bool first)
+{
+    // The list shown stays until the refreshed one is complete
+    if (first) {
+        m_refreshing = !sourceModelProjects->stringList().isEmpty();
+    }
+    if (m_refreshing) {
+        return;
+    }
+
+    if (first) {
+        resetProjectList(projects);
+    } else {
+        sourceModelProjects->appendProjects(projects);
+    }
+    m_streamed = true;
+}
+
+void ProjectTreeWidget::resetProjectList(const QStringList &projectList)
 {
     selectionModel()->clear(); // Emits selectionChanged() and currentChanged()
     sourceModelProjects->addProjectList(projectList);
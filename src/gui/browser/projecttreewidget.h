@@ -34,6 +34,7 @@ public:
     ProjectTreeWidget(QWidget *parent = nullptr);
     QString getCurrentProject() const;
     void addProjectList(const QStringList &projectList);
+    void addProjectListChunk(const QStringList &projects, bool first);
     void addProject(const QString &project);
     QStringList getProjectList() const;
     bool removeProject(const QString &project);
@@ -42,7 +43,10 @@ public:
 private:
     ProjectListModel *sourceModelProjects;
     QSortFilterProxyModel *proxyModelProjects;
+    bool m_streamed;
+    bool m_refreshing;
     void scrollToCurrentIndex();
+    void resetProjectList(const QStringList &projectList);
 
 public slots:
     bool setCurrentProject(const QString &project);
@@ -62,6 +62,7 @@ Configure::Configure(QWidget *parent, OBS *obs) :
     readProxySettings();
     readSettings();
     readTimerSettings();
+    readConnectionSettings();
 }
 
 Configure::~Configure()
@@ -104,6 +105,7 @@ void Configure::writeSettings()
     QSettings settings;
 
     writeProxySettings();
+    writeConnectionSettings();
 
     settings.beginGroup("Auth");
     settings.setValue("ApiUrl", mOBS->getApiUrl());
@@ -152,6 +154,17 @@ void Configure::writeProxySettings()
     settings.endGroup();
 }
 
+void Configure::writeConnectionSettings()
+{
+    qDebug() << "Configure::writeConnectionSettings()";
+    QSettings settings;
+    settings.beginGroup("Connection");
+    settings.setValue("Http2", ui->checkBoxHttp2->isChecked());
+    settings.setValue("MaxConnections", ui->spinBoxMaxConnections->value());
+    settings.setValue("NetworkThread", ui->checkBoxNetworkThread->isChecked());
+    settings.endGroup();
+}
+
 void Configure::readSettings()
 {
     qDebug() << "Configure::readSettings()";
@@ -204,6 +217,16 @@ void Configure::readProxySettings()
     ui->lineEditProxyPassword->setText(settings.value("Password").toString());
 }
 
+void Configure::readConnectionSettings()
+{
+    QSettings settings;
+    settings.beginGroup("Connection");
+    ui->checkBoxHttp2->setChecked(settings.value("Http2", false).toBool());
+    ui->spinBoxMaxConnections->setValue(settings.value("MaxConnections", 6).toInt());
+    ui->checkBoxNetworkThread->setChecked(settings.value("NetworkThread", false).toBool());
+    settings.endGroup();
+}
+
 void Configure::readTimerSettings()
 {
     QSettings settings;
@@ -223,6 +246,7 @@ void Configure::on_buttonBox_accepted()
 
     writeSettings();
     emit proxyChanged();
+    emit connectionSettingsChanged();
 
     if (includeHomeProjects!=ui->checkBoxHomeProjects->isChecked()) {
         emit includeHomeProjectsChanged();
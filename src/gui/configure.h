@@ -51,6 +51,7 @@ public:
 signals:
     void apiChanged();
     void proxyChanged();
+    void connectionSettingsChanged();
     void includeHomeProjectsChanged();
     void timerChanged();
 
@@ -64,6 +65,7 @@ private:
     void setOBSApiUrl(const QString &apiUrlStr);
     void readProxySettings();
     void readTimerSettings();
+    void readConnectionSettings();
     Login *login;
     void proxySettingsSetup();
     QNetworkProxy proxy;
@@ -71,6 +73,7 @@ private:
     enum ProxyType { NoProxy, SystemProxy, ManualProxy };
     void writeSettings();
     void writeProxySettings();
+    void writeConnectionSettings();
 };
 
 #endif // CONFIGURE_H
@@ -41,6 +41,7 @@ MainWindow::MainWindow(QWidget *parent) :
     loginDialog(nullptr)
 {
     ui->setupUi(this);
+    startNetworkThread();
 
     createActions();
     setupTreeMonitor();
@@ -121,6 +122,10 @@ void MainWindow::slotCredentialsRestored(const QString &username, const QString
 {
     qDebug() << "MainWindow::slotCredentialsRestored()";
     slotLogin(username, password);
+    // Populate the views from the response cache while logging in
+    browser->getProjects();
+    obs->getIncomingRequests();
+    obs->getOutgoingRequests();
     QProgressDialog progress(tr("Logging in..."), nullptr, 0, 0, this);
     progress.setWindowModality(Qt::WindowModal);
     progress.show();
@@ -238,6 +243,8 @@ void MainWindow::setupActions()
     action_createRequest->setEnabled(packageSelected);
     action_linkPackage->setEnabled(packageSelected);
     action_copyPackage->setEnabled(packageSelected);
+    action_downloadPackage->setEnabled(packageSelected);
+    action_checkoutPackage->setEnabled(packageSelected);
     ui->action_Upload_file->setEnabled(packageSelected);
     actionDelete_package->setEnabled(packageSelected);
     actionProperties_package->setEnabled(packageSelected);
@@ -250,6 +257,7 @@ void MainWindow::setupActions()
 
     bool buildResultSelected = browser->hasBuildResultSelection();
     action_getBuildLog->setEnabled(buildResultSelected);
+    action_showBinaries->setEnabled(buildResultSelected);
 }
 
 void MainWindow::setupProjectShortcuts()
@@ -487,6 +495,11 @@ void MainWindow::createActions()
     action_getBuildLog->setIcon(QIcon::fromTheme("text-x-log"));
     connect(action_getBuildLog, &QAction::triggered, browser, &Browser::getBuildLog);
 
+    // Binaries action
+    action_showBinaries = new QAction(tr("Show &binaries"), this);
+    action_showBinaries->setIcon(QIcon::fromTheme("package-x-generic"));
+    connect(action_showBinaries, &QAction::triggered, browser, &Browser::showBinaries);
+
     // Create request action
     action_createRequest = new QAction(tr("&Submit package"), this);
     action_createRequest->setIcon(QIcon::fromTheme("cloud-upload"));
@@ -502,6 +515,24 @@ void MainWindow::createActions()
     action_copyPackage->setIcon(QIcon::fromTheme("edit-copy"));
     connect(action_copyPackage, &QAction::triggered, browser, &Browser::copyPackage);
 
+    // Download package action
+    action_downloadPackage = new QAction(tr("Do&wnload package"), this);
+    action_downloadPackage->setIcon(QIcon::fromTheme("download"));
+    connect(action_downloadPackage, &QAction::triggered, browser, &Browser::downloadPackage);
+
+    // Working copy actions
+    action_checkoutPackage = new QAction(tr("C&heck out package"), this);
+    action_checkoutPackage->setIcon(QIcon::fromTheme("folder-download"));
+    connect(action_checkoutPackage, &QAction::triggered, browser, &Browser::checkoutPackage);
+
+    action_updateWorkingCopy = new QAction(tr("&Update working copy"), this);
+    action_updateWorkingCopy->setIcon(QIcon::fromTheme("view-refresh"));
+    connect(action_updateWorkingCopy, &QAction::triggered, browser, &Browser::updateWorkingCopy);
+
+    action_commitWorkingCopy = new QAction(tr("Co&mmit working copy"), this);
+    action_commitWorkingCopy->setIcon(QIcon::fromTheme("document-save"));
+    connect(action_commitWorkingCopy, &QAction::triggered, browser, &Browser::commitWorkingCopy);
+
     // Delete actions
     actionDelete_project = new QAction(tr("Delete pro&ject"), this);
     actionDelete_project->setIcon(QIcon::fromTheme("trash-empty"));
@@ -561,6 +592,10 @@ void MainWindow::createActions()
     treePackagesMenu->addAction(action_createRequest);
     treePackagesMenu->addAction(action_linkPackage);
     treePackagesMenu->addAction(action_copyPackage);
+    treePackagesMenu->addAction(action_downloadPackage);
+    treePackagesMenu->addAction(action_checkoutPackage);
+    treePackagesMenu->addAction(action_updateWorkingCopy);
+    treePackagesMenu->addAction(action_commitWorkingCopy);
     treePackagesMenu->addAction(action_ReloadPackages);
     treePackagesMenu->addAction(actionDelete_package);
     treePackagesMenu->addAction(actionProperties_package);
@@ -573,6 +608,7 @@ void MainWindow::createActions()
 
     QMenu *treeResultsMenu = new QMenu(this);
     treeResultsMenu->addAction(action_getBuildLog);
+    treeResultsMenu->addAction(action_showBinaries);
     treeResultsMenu->addAction(action_ReloadResults);
 
     browser->createProjectsContextMenu(treeProjectsMenu);
@@ -679,6 +715,7 @@ void MainWindow::readSettings()
     qDebug() << "MainWindow::readSettings()";
     readMWSettings();
     readProxySettings();
+    readConnectionSettings();
     readAuthSettings();
 }
 
@@ -745,6 +782,27 @@ void MainWindow::readProxySettings()
     settings.endGroup();
 }
 
+void MainWindow::readConnectionSettings()
+{
+    qDebug() << "MainWindow::readConnectionSettings()";
+    QSettings settings;
+    settings.beginGroup("Connection");
+    obs->setHttp2Enabled(settings.value("Http2", false).toBool());
+    obs->setMaxConnections(settings.value("MaxConnections", 6).toInt());
+    settings.endGroup();
+}
+
+void MainWindow::startNetworkThread()
+{
+    // Only read at startup, OBSCore can't move back to the GUI thread
+    QSettings settings;
+    settings.beginGroup("Connection");
+    if (settings.value("NetworkThread", false).toBool()) {
+        obs->startNetworkThread();
+    }
+    settings.endGroup();
+}
+
 void MainWindow::slotApiNotFound(QUrl url)
 {
     qDebug() << " MainWindow::slotApiNotFound()";
@@ -791,6 +849,7 @@ void MainWindow::on_action_Configure_Qactus_triggered()
     Configure *configure = new Configure(this, obs);
     connect(configure, &Configure::apiChanged, this, &MainWindow::slotApiChanged);
     connect(configure, &Configure::proxyChanged, this, &MainWindow::readProxySettings);
+    connect(configure, &Configure::connectionSettingsChanged, this, &MainWindow::readConnectionSettings);
     connect(configure, &Configure::includeHomeProjectsChanged, this, [=](){
         browser->readSettings();
         browser->getProjects();
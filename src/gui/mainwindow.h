@@ -77,6 +77,10 @@ private:
     QAction *action_createRequest;
     QAction *action_linkPackage;
     QAction *action_copyPackage;
+    QAction *action_downloadPackage;
+    QAction *action_checkoutPackage;
+    QAction *action_updateWorkingCopy;
+    QAction *action_commitWorkingCopy;
     QAction *actionNew_package;
     QAction *actionNew_project;
     QAction *actionNew;
@@ -93,6 +97,7 @@ private:
     QAction *action_ReloadResults;
 
     QAction *action_getBuildLog;
+    QAction *action_showBinaries;
 
     QAction *actionDelete_project;
     QAction *actionDelete_package;
@@ -132,6 +137,7 @@ private:
 
     void writeSettings();
     void readSettings();
+    void startNetworkThread();
     void readMWSettings();
     void readAuthSettings();
 
@@ -152,6 +158,7 @@ signals:
 
 private slots:
     void readProxySettings();
+    void readConnectionSettings();
     void slotApiNotFound(QUrl url);
     void startTimer(bool authenticated);
     void readTimerSettings();
@@ -41,6 +41,7 @@ Monitor::Monitor(QWidget *parent, OBS *obs) :
     connect(this, &Monitor::markAllRead, ui->treeMonitor, &MonitorTreeWidget::slotMarkAllRead);
     connect(ui->treeMonitor, &MonitorTreeWidget::notifyChanged, this, &Monitor::notifyChanged);
     connect(ui->treeMonitor, &MonitorTreeWidget::updateStatusBar, this, &Monitor::updateStatusBar);
+    connect(m_obs, &OBS::buildResultsChanged, ui->treeMonitor, &MonitorTreeWidget::getBuildStatus);
 
     ui->treeMonitor->setOBS(m_obs);
 }
@@ -19,6 +19,7 @@
  */
 
 #include "monitortreewidget.h"
+#include <QMap>
 
 MonitorTreeWidget::MonitorTreeWidget(QWidget *parent) :
     QTreeWidget(parent)
@@ -94,9 +95,13 @@ void MonitorTreeWidget::setOBS(OBS *obs)
     this->obs = obs;
 }
 
-void MonitorTreeWidget::getBuildStatus()
+void MonitorTreeWidget::getBuildStatus(const QString &project)
 {
-    qDebug() << "MonitorTreeWidget::getBuildStatus()";
+    qDebug() << "MonitorTreeWidget::getBuildStatus()" << project;
+    // One request per project instead of one per row
+    QMap<QString, QList<QStringList>> builds;
+    QMap<QString, QList<int>> buildRows;
+
     int rows = topLevelItemCount();
     for (int r=0; r<rows; r++) {
 //        Ignore rows with empty cells and process rows with data
@@ -104,15 +109,36 @@ void MonitorTreeWidget::getBuildStatus()
                 !topLevelItem(r)->text(1).isEmpty() ||
                 !topLevelItem(r)->text(2).isEmpty() ||
                 !topLevelItem(r)->text(3).isEmpty()) {
-            QStringList tableStringList;
-            tableStringList.append(QString(topLevelItem(r)->text(0)));
-            tableStringList.append(QString(topLevelItem(r)->text(2)));
-            tableStringList.append(QString(topLevelItem(r)->text(3)));
-            tableStringList.append(QString(topLevelItem(r)->text(1)));
-//            Get build status
-            obs->getBuildStatus(tableStringList, r);
+            QString rowProject = topLevelItem(r)->text(0);
+            if (!project.isEmpty() && rowProject != project) {
+                continue;
+            }
+            QStringList build;
+            build.append(QString(topLevelItem(r)->text(2)));
+            build.append(QString(topLevelItem(r)->text(3)));
+            build.append(QString(topLevelItem(r)->text(1)));
+            builds[rowProject].append(build);
+            buildRows[rowProject].append(r);
         }
     }
+
+//    Get build status
+    QHash<QString, QStringList> watchedPackages;
+    for (const QString &buildProject : builds.keys()) {
+        obs->getProjectBuildStatus(buildProject, builds.value(buildProject), buildRows.value(buildProject));
+
+        QStringList packages;
+        for (const QStringList &build : builds.value(buildProject)) {
+            packages.append(build.at(2));
+        }
+        packages.removeDuplicates();
+        watchedPackages.insert(buildProject, packages);
+    }
+
+//    Keep an eye on the monitored projects between refreshes
+    if (project.isEmpty()) {
+        obs->watchBuildResults(watchedPackages);
+    }
 }
 
 void MonitorTreeWidget::dragEnterEvent(QDragEnterEvent *event)
@@ -41,7 +41,7 @@ public:
     MonitorTreeWidget(QWidget *parent = 0);
     ~MonitorTreeWidget();
     void setOBS(OBS *obs);
-    void getBuildStatus();
+    void getBuildStatus(const QString &project = QString());
 
 protected:
     void dragEnterEvent(QDragEnterEvent *event);
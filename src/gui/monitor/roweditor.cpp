@@ -140,7 +140,7 @@ void RowEditor::autocompletedProjectName_clicked(const QString &projectName)
 {
     ui->lineEditPackage->setFocus();
 
-    connect(m_obs, SIGNAL(finishedParsingPackageList(QStringList)), this, SLOT(insertPackageList(QStringList)));
+    connect(m_obs, SIGNAL(finishedParsingPackageList(QStringList,QString)), this, SLOT(insertPackageList(QStringList)));
     m_obs->getPackages(projectName);
 }
 
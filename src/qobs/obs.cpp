@@ -25,15 +25,30 @@ OBS::OBS(QObject *parent) : QObject(parent)
     obsCore = OBSCore::getInstance();
     xmlReader = OBSXmlReader::getInstance();
     includeHomeProjects = false;
+    buildWatcher = new OBSBuildWatcher(this);
+    downloadManager = new OBSDownloadManager(this);
 
     // Forward signals
     connect(obsCore, SIGNAL(apiNotFound(QUrl)), this, SIGNAL(apiNotFound(QUrl)));
     connect(obsCore, SIGNAL(isAuthenticated(bool)),
             this, SIGNAL(isAuthenticated(bool)));
-    connect(obsCore, SIGNAL(selfSignedCertificate(QNetworkReply*)),
-            this, SIGNAL(selfSignedCertificate(QNetworkReply*)));
+    // On the network thread the reply is held, not ignored, and sent again
+    // if the handler added its certificate to the trusted ones
+    connect(obsCore, &OBSCore::selfSignedCertificate, this, [this](QNetworkReply *reply) {
+        if (QThread::currentThread() == thread()) {
+            emit selfSignedCertificate(reply);
+            return;
+        }
+        QMetaObject::invokeMethod(this, [this, reply]() {
+            QSslCertificate certificate = reply->sslConfiguration().peerCertificate();
+            emit selfSignedCertificate(reply);
+            bool accepted = QSslConfiguration::defaultConfiguration().caCertificates().contains(certificate);
+            obsCore->answerSelfSignedCertificate(reply, accepted);
+        }, Qt::QueuedConnection);
+    }, Qt::DirectConnection);
     connect(obsCore, SIGNAL(networkError(QString)),
             this, SIGNAL(networkError(QString)));
+    connect(buildWatcher, &OBSBuildWatcher::buildResultsChanged, this, &OBS::buildResultsChanged);
     connect(xmlReader, SIGNAL(finishedParsingPackage(OBSStatus*,int)),
             this, SIGNAL(finishedParsingPackage(OBSStatus*,int)));
 
@@ -61,7 +76,20 @@ OBS::OBS(QObject *parent) : QObject(parent)
             this, SIGNAL(finishedParsingUploadFileRevision(OBSRevision*)));
     connect(obsCore, SIGNAL(cannotUploadFile(OBSStatus*)),
             this, SIGNAL(cannotUploadFile(OBSStatus*)));
-    connect(obsCore, SIGNAL(fileFetched(QString,QByteArray)), this, SIGNAL(fileFetched(QString,QByteArray)));
+    connect(obsCore, &OBSCore::commitProgress, this, &OBS::commitProgress);
+    connect(obsCore, &OBSCore::commitFailed, this, &OBS::commitFailed);
+    connect(obsCore, &OBSCore::nothingToCommit, this, &OBS::nothingToCommit);
+    connect(xmlReader, &OBSXmlReader::finishedParsingCommitRevision, this, &OBS::finishedParsingCommitRevision);
+    connect(obsCore, &OBSCore::fileUploadProgress, this, &OBS::fileUploadProgress);
+    connect(obsCore, &OBSCore::fileUploadFinished, this, &OBS::fileUploadFinished);
+    connect(obsCore, &OBSCore::fileDownloadProgress, this, &OBS::fileDownloadProgress);
+    connect(obsCore, &OBSCore::fileDownloaded, this, &OBS::fileDownloaded);
+    connect(obsCore, &OBSCore::fileDownloadFailed, this, &OBS::fileDownloadFailed);
+    connect(obsCore, &OBSCore::archiveDownloadProgress, this, &OBS::archiveDownloadProgress);
+    connect(obsCore, &OBSCore::archiveDownloaded, this, &OBS::archiveDownloaded);
+    connect(obsCore, &OBSCore::archiveDownloadFailed, this, &OBS::archiveDownloadFailed);
+    connect(obsCore, &OBSCore::fileContentsFetched, this, &OBS::fileContentsFetched);
+    connect(obsCore, &OBSCore::fileContentsFailed, this, &OBS::fileContentsFailed);
     connect(obsCore, SIGNAL(buildLogFetched(QString)), this, SIGNAL(buildLogFetched(QString)));
     connect(obsCore, SIGNAL(buildLogNotFound()), this, SIGNAL(buildLogNotFound()));
     connect(obsCore, &OBSCore::projectNotFound, this, &OBS::projectNotFound);
@@ -93,20 +121,21 @@ OBS::OBS(QObject *parent) : QObject(parent)
     connect(xmlReader, &OBSXmlReader::finishedParsingDeclinedRequest, this, &OBS::finishedParsingDeclinedRequest);
     connect(xmlReader, &OBSXmlReader::finishedParsingDeclinedRequestList, this, &OBS::finishedParsingDeclinedRequestList);
 
-    connect(xmlReader, &OBSXmlReader::projectFetched, this, &OBS::projectFetched);
+    connect(xmlReader, &OBSXmlReader::projectListChunkFetched, this, &OBS::projectListChunkFetched);
 
     connect(xmlReader, SIGNAL(finishedParsingProjectList(QStringList)),
             this, SIGNAL(finishedParsingProjectList(QStringList)));
     connect(xmlReader, &OBSXmlReader::finishedParsingProjectMetaConfig, this, &OBS::finishedParsingProjectMetaConfig);
     connect(xmlReader, &OBSXmlReader::finishedParsingPackageMetaConfig, this, &OBS::finishedParsingPackageMetaConfig);
-    connect(xmlReader, SIGNAL(finishedParsingPackageList(QStringList)),
-            this, SIGNAL(finishedParsingPackageList(QStringList)));
+    connect(xmlReader, &OBSXmlReader::packageListChunkFetched, this, &OBS::packageListChunkFetched);
+    connect(xmlReader, &OBSXmlReader::finishedParsingPackageList, this, &OBS::finishedParsingPackageList);
     connect(xmlReader, SIGNAL(finishedParsingList(QStringList)),
             this, SIGNAL(finishedParsingList(QStringList)));
     connect(xmlReader, SIGNAL(finishedParsingFile(OBSFile*)),
             this, SIGNAL(finishedParsingFile(OBSFile*)));
     connect(xmlReader, SIGNAL(finishedParsingFileList()),
             this, SIGNAL(finishedParsingFileList()));
+    connect(xmlReader, &OBSXmlReader::finishedParsingBinaryList, this, &OBS::finishedParsingBinaryList);
     connect(xmlReader, &OBSXmlReader::finishedParsingLink, this, &OBS::finishedParsingLink);
     connect(xmlReader, &OBSXmlReader::finishedParsingRequestStatus, this, &OBS::finishedParsingRequestStatus);
     connect(obsCore, SIGNAL(srDiffFetched(QString)),
@@ -174,11 +203,17 @@ void OBS::getBuildStatus(const QStringList &stringList, int row)
     obsCore->getBuildStatus(stringList, row);
 }
 
-void OBS::getAllBuildStatus(const QString &project, const QString &package)
+void OBS::getProjectBuildStatus(const QString &project, const QList<QStringList> &builds, const QList<int> &rows)
+{
+    //    URL format: https://api.opensuse.org/build/<project>/_result?package=<package>&repository=<repository>&arch=<arch>
+    obsCore->getProjectBuildStatus(project, builds, rows);
+}
+
+OBSRequestHandle OBS::getAllBuildStatus(const QString &project, const QString &package)
 {
     //    URL format: https://api.opensuse.org/build/<project>/_result?package=<package>
     QString resource = QString("%1/%2%3").arg(project, "_result?package=", package);
-    obsCore->getAllBuildStatus(resource);
+    return obsCore->getAllBuildStatus(resource);
 }
 
 void OBS::getRevisions(const QString &project, const QString &package)
@@ -247,9 +282,9 @@ void OBS::getProjects()
     obsCore->getProjects();
 }
 
-void OBS::getPackages(const QString &project)
+OBSRequestHandle OBS::getPackages(const QString &project)
 {
-    obsCore->getPackages("/" + project);
+    return obsCore->getPackages("/" + project);
 }
 
 void OBS::getProjectMetaConfig(const QString &project)
@@ -262,9 +297,14 @@ void OBS::getPackageMetaConfig(const QString &project, const QString &package)
     obsCore->getPackageMetaConfig("/" + project + "/" + package + "/_meta");
 }
 
-void OBS::getFiles(const QString &project, const QString &package)
+OBSRequestHandle OBS::getFiles(const QString &project, const QString &package)
+{
+    return obsCore->getFiles(project, package);
+}
+
+void OBS::cancelRequest(const OBSRequestHandle &handle)
 {
-    obsCore->getFiles(project, package);
+    obsCore->cancelRequest(handle);
 }
 
 void OBS::getLink(const QString &project, const QString &package)
@@ -313,9 +353,46 @@ void OBS::uploadFile(const QString &project, const QString &package, const QStri
     obsCore->uploadFile(project, package, fileName, data);
 }
 
-void OBS::downloadFile(const QString &project, const QString &package, const QString &fileName)
+OBSRequestHandle OBS::uploadFile(const QString &project, const QString &package, const QString &fileName,
+                                 const QString &path)
+{
+    return obsCore->uploadFile(project, package, fileName, path);
+}
+
+OBSRequestHandle OBS::commitFiles(const QString &project, const QString &package, const QStringList &paths,
+                                  const QString &comment)
+{
+    return obsCore->commitFiles(project, package, paths, comment);
+}
+
+OBSRequestHandle OBS::downloadFile(const QString &project, const QString &package, const QString &fileName,
+                                   const QString &path)
 {
-    obsCore->downloadFile(project, package, fileName);
+    return obsCore->downloadFile(project, package, fileName, path);
+}
+
+OBSRequestHandle OBS::downloadPackage(const QString &project, const QString &package, const QString &directory)
+{
+    return obsCore->downloadPackage(project, package, directory);
+}
+
+OBSRequestHandle OBS::getFileContents(const QString &project, const QString &package, const QString &fileName,
+                                      const QString &md5)
+{
+    return obsCore->getFileContents(project, package, fileName, md5);
+}
+
+OBSRequestHandle OBS::getBinaryList(const QString &project, const QString &repository, const QString &arch,
+                                    const QString &package)
+{
+    return obsCore->getBinaryList(project, repository, arch, package);
+}
+
+OBSRequestHandle OBS::downloadBinaries(const QString &project, const QString &repository, const QString &arch,
+                                       const QString &package, const QStringList &binaries,
+                                       const QString &directory)
+{
+    return obsCore->downloadBinaries(project, repository, arch, package, binaries, directory);
 }
 
 void OBS::getBuildLog(const QString &project, const QString &repository, const QString &arch, const QString &package)
@@ -357,3 +434,38 @@ void OBS::getDistributions()
 {
     obsCore->getDistributions();
 }
+
+OBSRequestScheduler *OBS::getRequestScheduler() const
+{
+    return obsCore->getRequestScheduler();
+}
+
+OBSDownloadManager *OBS::getDownloadManager() const
+{
+    return downloadManager;
+}
+
+void OBS::startNetworkThread()
+{
+    obsCore->startNetworkThread();
+}
+
+bool OBS::isHttp2Enabled() const
+{
+    return obsCore->isHttp2Enabled();
+}
+
+void OBS::setHttp2Enabled(bool enabled)
+{
+    obsCore->setHttp2Enabled(enabled);
+}
+
+void OBS::setMaxConnections(int maxConnections)
+{
+    obsCore->setMaxConnections(maxConnections);
+}
+
+void OBS::watchBuildResults(const QHash<QString, QStringList> &packages)
+{
+    buildWatcher->setWatchedPackages(packages);
+}
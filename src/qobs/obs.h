@@ -25,6 +25,8 @@
 #include "obscore.h"
 #include "obsxmlreader.h"
 #include "obsstatus.h"
+#include "obsbuildwatcher.h"
+#include "obsdownloadmanager.h"
 
 #if defined(QOBS_LIBRARY)
 #  define QOBS_EXPORT Q_DECL_EXPORT
@@ -47,6 +49,7 @@ public:
     bool isAuthenticated();
     void login();
     void getBuildStatus(const QStringList &stringList, int row);
+    void getProjectBuildStatus(const QString &project, const QList<QStringList> &builds, const QList<int> &rows);
     void getRevisions(const QString &project, const QString &package);
     void getIncomingRequests();
     void getOutgoingRequests();
@@ -56,10 +59,11 @@ public:
     bool isIncludeHomeProjects() const;
     void setIncludeHomeProjects(bool value);
     void getProjects();
-    void getPackages(const QString &project);
+    OBSRequestHandle getPackages(const QString &project);
     void getProjectMetaConfig(const QString &project);
     void getPackageMetaConfig(const QString &project, const QString &package);
-    void getFiles(const QString &project, const QString &package);
+    OBSRequestHandle getFiles(const QString &project, const QString &package);
+    void cancelRequest(const OBSRequestHandle &handle);
     void getLink(const QString &project, const QString &package);
     void changeSubmitRequest(const QString &resource, const QByteArray &data);
     OBSXmlReader *getXmlReader();
@@ -75,16 +79,26 @@ public:
     void getPerson();
     void updatePerson(const QByteArray &data);
     void getDistributions();
+    OBSRequestScheduler *getRequestScheduler() const;
+    OBSDownloadManager *getDownloadManager() const;
+    void startNetworkThread();
+    bool isHttp2Enabled() const;
+    void setHttp2Enabled(bool enabled);
+    void setMaxConnections(int maxConnections);
+    void watchBuildResults(const QHash<QString, QStringList> &packages);
 
 private:
     OBSCore *obsCore;
     OBSXmlReader *xmlReader;
+    OBSBuildWatcher *buildWatcher;
+    OBSDownloadManager *downloadManager;
     bool includeHomeProjects;
     void postRequest(const QString &resource, const QByteArray &data, const QString &contentTypeHeader);
     void deleteRequest(const QString &resource);
 
 signals:
     void apiNotFound(QUrl url);
+    void buildResultsChanged(const QString &project);
     void isAuthenticated(bool);
     void selfSignedCertificate(QNetworkReply*);
     void networkError(const QString&);
@@ -102,7 +116,22 @@ signals:
     void cannotCreatePackage(OBSStatus *obsStatus);
     void finishedParsingUploadFileRevision(OBSRevision*);
     void cannotUploadFile(OBSStatus *obsStatus);
-    void fileFetched(const QString &fileName, const QByteArray &data);
+    void commitProgress(const QString &project, const QString &package, const QString &message);
+    void commitFailed(const QString &project, const QString &package, const QString &errorString);
+    void nothingToCommit(const QString &project, const QString &package);
+    void finishedParsingCommitRevision(OBSRevision *revision);
+    void fileUploadProgress(const QString &path, qint64 bytesSent, qint64 bytesTotal);
+    void fileUploadFinished(const QString &path);
+    void fileDownloadProgress(const QString &path, qint64 bytesReceived, qint64 bytesTotal);
+    void fileDownloaded(const QString &path);
+    void fileDownloadFailed(const QString &path, const QString &errorString);
+    void archiveDownloadProgress(const QString &directory, qint64 bytesReceived, qint64 bytesTotal);
+    void archiveDownloaded(const QString &directory, const QStringList &files);
+    void archiveDownloadFailed(const QString &directory, const QString &errorString);
+    void fileContentsFetched(const QString &project, const QString &package, const QString &fileName,
+                             const QByteArray &data);
+    void fileContentsFailed(const QString &project, const QString &package, const QString &fileName,
+                            const QString &errorString);
     void buildLogFetched(const QString &buildLog);
     void buildLogNotFound();
     void projectNotFound(OBSStatus *status);
@@ -123,13 +152,16 @@ signals:
     void finishedParsingDeclinedRequest(OBSRequest *request);
     void finishedParsingDeclinedRequestList();
     void finishedParsingProjectList(QStringList);
-    void projectFetched(const QString &project);
+    void projectListChunkFetched(const QStringList &projects, bool first);
     void finishedParsingProjectMetaConfig(OBSPrjMetaConfig *prjMetaConfig);
     void finishedParsingPackageMetaConfig(OBSPkgMetaConfig *pkgMetaConfig);
-    void finishedParsingPackageList(QStringList);
+    void packageListChunkFetched(const QStringList &packages, const QString &project, bool first);
+    void finishedParsingPackageList(const QStringList &packageList, const QString &project);
     void finishedParsingList(QStringList);
     void finishedParsingFile(OBSFile*);
     void finishedParsingFileList();
+    void finishedParsingBinaryList(const QString &project, const QString &repository, const QString &arch,
+                                   const QString &package, const QList<OBSFile> &binaries);
     void finishedParsingLink(OBSLink *obsLink);
     void finishedParsingRequestStatus(OBSStatus *status);
     void srDiffFetched(const QString &);
@@ -139,13 +171,25 @@ signals:
     void finishedParsingDistribution(OBSDistribution *distribution);
 
 public slots:
-    void getAllBuildStatus(const QString &project, const QString &package);
+    OBSRequestHandle getAllBuildStatus(const QString &project, const QString &package);
     void slotChangeSubmitRequest(const QString &id, const QString &comments, bool accepted);
     void createRequest(const QByteArray &data);
     void createProject(const QString &project, const QByteArray &data);
     void createPackage(const QString &project, const QString &package, const QByteArray &data);
     void uploadFile(const QString &project, const QString &package, const QString &fileName, const QByteArray &data);
-    void downloadFile(const QString &project, const QString &package, const QString &fileName);
+    OBSRequestHandle uploadFile(const QString &project, const QString &package, const QString &fileName,
+                                const QString &path);
+    OBSRequestHandle commitFiles(const QString &project, const QString &package, const QStringList &paths,
+                                 const QString &comment);
+    OBSRequestHandle downloadFile(const QString &project, const QString &package, const QString &fileName,
+                                  const QString &path);
+    OBSRequestHandle downloadPackage(const QString &project, const QString &package, const QString &directory);
+    OBSRequestHandle getFileContents(const QString &project, const QString &package, const QString &fileName,
+                                     const QString &md5);
+    OBSRequestHandle getBinaryList(const QString &project, const QString &repository, const QString &arch,
+                                   const QString &package);
+    OBSRequestHandle downloadBinaries(const QString &project, const QString &repository, const QString &arch,
+                                      const QString &package, const QStringList &binaries, const QString &directory);
     void getBuildLog(const QString &project, const QString &repository, const QString &arch, const QString &package);
 };
 
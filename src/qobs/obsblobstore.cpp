@@ -0,0 +1,228 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obsblobstore.h"
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <algorithm>
+
+static const qint64 copyBufferSize = 64 * 1024;
+// Blobs may come from private packages, only the user can read them
+static const QFileDevice::Permissions filePermissions = QFileDevice::ReadOwner | QFileDevice::WriteOwner;
+static const QFileDevice::Permissions directoryPermissions = filePermissions | QFileDevice::ExeOwner;
+
+static bool copyDevice(QIODevice *source, QSaveFile *destination)
+{
+    QByteArray buffer;
+    while (!source->atEnd()) {
+        buffer = source->read(copyBufferSize);
+        if (buffer.isEmpty() || destination->write(buffer) != buffer.size()) {
+            return false;
+        }
+    }
+    return destination->commit();
+}
+
+OBSBlobStore::OBSBlobStore(const QString &directory) :
+    m_directory(directory),
+    m_maximumSize(200 * 1024 * 1024),
+    m_currentSize(-1)
+{
+    if (m_directory.isEmpty()) {
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/blobs";
+    }
+    QDir().mkpath(m_directory);
+    QFile::setPermissions(m_directory, directoryPermissions);
+}
+
+QString OBSBlobStore::getDirectory() const
+{
+    return m_directory;
+}
+
+qint64 OBSBlobStore::getMaximumSize() const
+{
+    return m_maximumSize;
+}
+
+void OBSBlobStore::setMaximumSize(qint64 maximumSize)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maximumSize = maximumSize;
+    expire();
+}
+
+bool OBSBlobStore::isValidHash(const QString &md5)
+{
+    // Also keeps anything but a hash out of the paths
+    static const QRegularExpression hashRegExp("^[0-9a-f]{32}$");
+    return hashRegExp.match(md5).hasMatch();
+}
+
+bool OBSBlobStore::contains(const QString &md5) const
+{
+    return isValidHash(md5) && QFileInfo::exists(blobPath(md5));
+}
+
+QString OBSBlobStore::blobPath(const QString &md5) const
+{
+    // Spread over 256 directories
+    return m_directory + "/" + md5.left(2) + "/" + md5;
+}
+
+bool OBSBlobStore::read(const QString &md5, QByteArray &data) const
+{
+    if (!isValidHash(md5)) {
+        return false;
+    }
+    QFile file(blobPath(md5));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    data = file.readAll();
+    return true;
+}
+
+bool OBSBlobStore::copyTo(const QString &md5, const QString &path) const
+{
+    if (!isValidHash(md5)) {
+        return false;
+    }
+    QFile source(blobPath(md5));
+    if (!source.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QSaveFile destination(path);
+    if (!destination.open(QIODevice::WriteOnly) || !copyDevice(&source, &destination)) {
+        qDebug() << "OBSBlobStore::copyTo() Cannot write" << path << destination.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool OBSBlobStore::insert(const QString &md5, const QByteArray &data)
+{
+    if (!isValidHash(md5)) {
+        return false;
+    }
+    QString path = blobPath(md5);
+    qint64 oldSize = QFileInfo(path).size();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || !file.setPermissions(filePermissions) ||
+            file.write(data) != data.size() || !file.commit()) {
+        qDebug() << "OBSBlobStore::insert() Cannot write" << path << file.errorString();
+        return false;
+    }
+    added(path, oldSize);
+    return true;
+}
+
+bool OBSBlobStore::insertFile(const QString &md5, const QString &path)
+{
+    if (!isValidHash(md5)) {
+        return false;
+    }
+    QFile source(path);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QString blob = blobPath(md5);
+    qint64 oldSize = QFileInfo(blob).size();
+    QDir().mkpath(QFileInfo(blob).absolutePath());
+    QSaveFile destination(blob);
+    if (!destination.open(QIODevice::WriteOnly) || !destination.setPermissions(filePermissions) ||
+            !copyDevice(&source, &destination)) {
+        qDebug() << "OBSBlobStore::insertFile() Cannot write" << blob << destination.errorString();
+        return false;
+    }
+    added(blob, oldSize);
+    return true;
+}
+
+void OBSBlobStore::remove(const QString &md5)
+{
+    if (!isValidHash(md5)) {
+        return;
+    }
+    QString path = blobPath(md5);
+    qint64 size = QFileInfo(path).size();
+    QMutexLocker locker(&m_mutex);
+    if (QFile::remove(path) && m_currentSize >= 0) {
+        m_currentSize -= size;
+    }
+}
+
+void OBSBlobStore::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    QDir(m_directory).removeRecursively();
+    QDir().mkpath(m_directory);
+    QFile::setPermissions(m_directory, directoryPermissions);
+    m_currentSize = 0;
+}
+
+void OBSBlobStore::added(const QString &path, qint64 oldSize)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_currentSize >= 0) {
+        m_currentSize += QFileInfo(path).size() - oldSize;
+    }
+    expire();
+}
+
+void OBSBlobStore::expire()
+{
+    // Called with m_mutex locked
+    if (m_currentSize >= 0 && m_currentSize <= m_maximumSize) {
+        return;
+    }
+
+    QFileInfoList entries;
+    QDirIterator it(m_directory, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        entries.append(QDir(it.next()).entryInfoList(QDir::Files));
+    }
+
+    if (m_currentSize < 0) {
+        m_currentSize = 0;
+        for (const QFileInfo &entry : entries) {
+            m_currentSize += entry.size();
+        }
+    }
+
+    // Oldest blobs first
+    std::sort(entries.begin(), entries.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() < b.lastModified();
+    });
+    while (m_currentSize > m_maximumSize && !entries.isEmpty()) {
+        QFileInfo entry = entries.takeFirst();
+        if (QFile::remove(entry.filePath())) {
+            qDebug() << "OBSBlobStore::expire() Removed" << entry.fileName();
+            m_currentSize -= entry.size();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSBLOBSTORE_H
+#define OBSBLOBSTORE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+
+/*
+ * OBSBlobStore keeps the contents of source files on disk by md5, which is
+ * what the server lists for every file. Contents never change, so a blob
+ * can be used for any package and revision listing the same md5 without
+ * asking the server. Blobs are written to a temporary file and renamed, so the
+ * store can be used from several threads. Once it grows over its maximum
+ * size the least recently written blobs are removed.
+ *
+ */
+class OBSBlobStore
+{
+
+public:
+    explicit OBSBlobStore(const QString &directory = QString());
+    QString getDirectory() const;
+    qint64 getMaximumSize() const;
+    void setMaximumSize(qint64 maximumSize);
+    static bool isValidHash(const QString &md5);
+    bool contains(const QString &md5) const;
+    QString blobPath(const QString &md5) const;
+    bool read(const QString &md5, QByteArray &data) const;
+    bool copyTo(const QString &md5, const QString &path) const;
+    bool insert(const QString &md5, const QByteArray &data);
+    bool insertFile(const QString &md5, const QString &path);
+    void remove(const QString &md5);
+    void clear();
+
+private:
+    QString m_directory;
+    qint64 m_maximumSize;
+    qint64 m_currentSize;
+    mutable QMutex m_mutex;
+    void added(const QString &path, qint64 oldSize);
+    void expire();
+};
+
+#endif // OBSBLOBSTORE_H
@@ -0,0 +1,149 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obsbuildwatcher.h"
+#include <QTimer>
+#include <QDebug>
+
+OBSBuildWatcher::OBSBuildWatcher(QObject *parent) : QObject(parent),
+    m_obsCore(OBSCore::getInstance()),
+    m_retryInterval(60000)
+{
+    connect(m_obsCore, &OBSCore::buildResultsState, this, &OBSBuildWatcher::slotBuildResultsState);
+    connect(m_obsCore, &OBSCore::buildResultsWatchFailed, this, &OBSBuildWatcher::slotWatchFailed);
+    connect(m_obsCore, &OBSCore::sessionReset, this, &OBSBuildWatcher::slotSessionReset);
+}
+
+void OBSBuildWatcher::watch(const QString &project, const QStringList &packages)
+{
+    qDebug() << __PRETTY_FUNCTION__ << project << packages;
+    if (m_packages.value(project) == packages) {
+        return;
+    }
+    m_packages.insert(project, packages);
+    // A new package filter means a new state hash
+    m_states.remove(project);
+    cancelPoll(project);
+    poll(project);
+}
+
+void OBSBuildWatcher::unwatch(const QString &project)
+{
+    qDebug() << __PRETTY_FUNCTION__ << project;
+    m_packages.remove(project);
+    m_states.remove(project);
+    cancelPoll(project);
+}
+
+void OBSBuildWatcher::setWatchedPackages(const QHash<QString, QStringList> &packages)
+{
+    for (const QString &project : getProjects()) {
+        if (!packages.contains(project)) {
+            unwatch(project);
+        }
+    }
+
+    for (const QString &project : packages.keys()) {
+        watch(project, packages.value(project));
+    }
+}
+
+QStringList OBSBuildWatcher::getProjects() const
+{
+    return m_packages.keys();
+}
+
+void OBSBuildWatcher::poll(const QString &project)
+{
+    // Only one outstanding poll per project, its reply triggers the next one
+    if (m_polling.contains(project)) {
+        return;
+    }
+    m_polling.insert(project, m_obsCore->watchBuildResults(project, m_packages.value(project),
+                                                            m_states.value(project)));
+}
+
+void OBSBuildWatcher::cancelPoll(const QString &project)
+{
+    OBSRequestHandle handle = m_polling.take(project);
+    m_obsCore->cancelRequest(handle);
+}
+
+void OBSBuildWatcher::slotBuildResultsState(const QString &project, const QString &state,
+                                            const OBSRequestHandle &handle)
+{
+    // A cancelled poll can still answer, for a filter that's gone
+    if (m_polling.value(project) != handle) {
+        return;
+    }
+    m_polling.remove(project);
+    if (!m_packages.contains(project)) {
+        return;
+    }
+
+    QString oldState = m_states.value(project);
+    m_states.insert(project, state);
+
+    if (state.isEmpty()) {
+        // No state hash, don't hammer the server
+        retry(project);
+        return;
+    }
+
+    if (!oldState.isEmpty() && oldState != state) {
+        qDebug() << __PRETTY_FUNCTION__ << "Build results changed in" << project;
+        emit buildResultsChanged(project);
+    }
+    poll(project);
+}
+
+void OBSBuildWatcher::slotWatchFailed(const QString &project, const OBSRequestHandle &handle)
+{
+    if (m_polling.value(project) != handle) {
+        return;
+    }
+    m_polling.remove(project);
+    retry(project);
+}
+
+void OBSBuildWatcher::retry(const QString &project)
+{
+    if (!m_packages.contains(project)) {
+        return;
+    }
+
+    qDebug() << __PRETTY_FUNCTION__ << project << "Retrying in" << m_retryInterval << "ms";
+    QTimer::singleShot(m_retryInterval, this, [this, project]() {
+        if (m_packages.contains(project)) {
+            poll(project);
+        }
+    });
+}
+
+void OBSBuildWatcher::slotSessionReset()
+{
+    // The outstanding polls were dropped without a reply, start over
+    qDebug() << __PRETTY_FUNCTION__ << getProjects();
+    m_polling.clear();
+    m_states.clear();
+    for (const QString &project : getProjects()) {
+        poll(project);
+    }
+}
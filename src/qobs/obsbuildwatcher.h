@@ -0,0 +1,67 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSBUILDWATCHER_H
+#define OBSBUILDWATCHER_H
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include "obscore.h"
+
+/*
+ * OBSBuildWatcher keeps one long-poll on /build/<project>/_result per watched
+ * project. OBS answers as soon as the state hash differs from the oldstate
+ * sent, so buildResultsChanged() is emitted right after a change instead of
+ * on the next timer refresh. Changing the packages of a project cancels its
+ * poll, whose state was for the old ones, and sends a new one.
+ *
+ */
+class OBSBuildWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OBSBuildWatcher(QObject *parent = nullptr);
+    void watch(const QString &project, const QStringList &packages);
+    void unwatch(const QString &project);
+    void setWatchedPackages(const QHash<QString, QStringList> &packages);
+    QStringList getProjects() const;
+
+signals:
+    void buildResultsChanged(const QString &project);
+
+private:
+    OBSCore *m_obsCore;
+    QHash<QString, QStringList> m_packages;
+    QHash<QString, QString> m_states;
+    QHash<QString, OBSRequestHandle> m_polling;
+    void cancelPoll(const QString &project);
+    int m_retryInterval;
+    void poll(const QString &project);
+    void retry(const QString &project);
+
+private slots:
+    void slotBuildResultsState(const QString &project, const QString &state, const OBSRequestHandle &handle);
+    void slotWatchFailed(const QString &project, const OBSRequestHandle &handle);
+    void slotSessionReset();
+};
+
+#endif // OBSBUILDWATCHER_H
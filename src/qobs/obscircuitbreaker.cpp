@@ -0,0 +1,124 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obscircuitbreaker.h"
+#include <QDebug>
+
+OBSCircuitBreaker::OBSCircuitBreaker(QObject *parent) : QObject(parent),
+    m_state(Closed),
+    m_failures(0),
+    m_failureThreshold(5),
+    m_cooldown(30000),
+    m_currentCooldown(30000),
+    m_maxCooldown(600000),
+    m_cooldownTimer(new QTimer(this))
+{
+    m_cooldownTimer->setSingleShot(true);
+    connect(m_cooldownTimer, &QTimer::timeout, this, &OBSCircuitBreaker::slotCooldownFinished);
+}
+
+OBSCircuitBreaker::State OBSCircuitBreaker::getState() const
+{
+    return m_state;
+}
+
+int OBSCircuitBreaker::getFailureThreshold() const
+{
+    return m_failureThreshold;
+}
+
+void OBSCircuitBreaker::setFailureThreshold(int failureThreshold)
+{
+    m_failureThreshold = qMax(1, failureThreshold);
+}
+
+int OBSCircuitBreaker::getCooldown() const
+{
+    return m_cooldown;
+}
+
+void OBSCircuitBreaker::setCooldown(int msec)
+{
+    m_cooldown = qMax(1000, msec);
+    m_currentCooldown = m_cooldown;
+}
+
+void OBSCircuitBreaker::recordSuccess()
+{
+    m_failures = 0;
+    if (m_state == HalfOpen) {
+        m_currentCooldown = m_cooldown;
+        setState(Closed);
+    }
+}
+
+void OBSCircuitBreaker::recordFailure(int retryAfter)
+{
+    m_failures++;
+
+    switch (m_state) {
+    case Closed:
+        // The server told us how long to stay away
+        if (m_failures >= m_failureThreshold || retryAfter > 0) {
+            open(qMax(m_currentCooldown, retryAfter));
+        }
+        break;
+    case HalfOpen:
+        m_currentCooldown = qMin(m_currentCooldown * 2, m_maxCooldown);
+        open(qMax(m_currentCooldown, retryAfter));
+        break;
+    case Open:
+        // Replies of requests sent before opening
+        if (retryAfter > m_cooldownTimer->remainingTime()) {
+            m_cooldownTimer->start(retryAfter);
+        }
+        break;
+    }
+}
+
+void OBSCircuitBreaker::reset()
+{
+    m_failures = 0;
+    m_currentCooldown = m_cooldown;
+    m_cooldownTimer->stop();
+    setState(Closed);
+}
+
+void OBSCircuitBreaker::open(int msec)
+{
+    qDebug() << __PRETTY_FUNCTION__ << "API degraded, pausing for" << msec << "ms";
+    m_cooldownTimer->start(msec);
+    setState(Open);
+}
+
+void OBSCircuitBreaker::setState(State state)
+{
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    emit stateChanged(state);
+}
+
+void OBSCircuitBreaker::slotCooldownFinished()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+    setState(HalfOpen);
+}
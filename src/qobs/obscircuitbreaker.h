@@ -0,0 +1,73 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSCIRCUITBREAKER_H
+#define OBSCIRCUITBREAKER_H
+
+#include <QObject>
+#include <QTimer>
+
+/*
+ * OBSCircuitBreaker tracks the health of the API. After a number of
+ * consecutive transient failures it opens for a cooldown period, which
+ * doubles every time a trial request fails. Once the cooldown is over it is
+ * half open: the next reply closes it again or reopens it.
+ *
+ */
+class OBSCircuitBreaker : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Closed,
+        Open,
+        HalfOpen
+    };
+
+    explicit OBSCircuitBreaker(QObject *parent = nullptr);
+    State getState() const;
+    int getFailureThreshold() const;
+    void setFailureThreshold(int failureThreshold);
+    int getCooldown() const;
+    void setCooldown(int msec);
+    void recordSuccess();
+    void recordFailure(int retryAfter = 0);
+    void reset();
+
+signals:
+    void stateChanged(OBSCircuitBreaker::State state);
+
+private:
+    State m_state;
+    int m_failures;
+    int m_failureThreshold;
+    int m_cooldown;
+    int m_currentCooldown;
+    int m_maxCooldown;
+    QTimer *m_cooldownTimer;
+    void open(int msec);
+    void setState(State state);
+
+private slots:
+    void slotCooldownFinished();
+};
+
+#endif // OBSCIRCUITBREAKER_H
@@ -0,0 +1,118 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obscookiejar.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QStandardPaths>
+
+OBSCookieJar::OBSCookieJar(const QString &fileName, QObject *parent) :
+    QNetworkCookieJar(parent),
+    m_fileName(fileName)
+{
+    if (m_fileName.isEmpty()) {
+        m_fileName = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/cookies/default";
+    }
+    load();
+}
+
+QString OBSCookieJar::getFileName() const
+{
+    return m_fileName;
+}
+
+void OBSCookieJar::setFileName(const QString &fileName)
+{
+    if (m_fileName == fileName) {
+        return;
+    }
+    m_fileName = fileName;
+    load();
+}
+
+bool OBSCookieJar::setCookiesFromUrl(const QList<QNetworkCookie> &cookieList, const QUrl &url)
+{
+    bool changed = QNetworkCookieJar::setCookiesFromUrl(cookieList, url);
+    if (changed) {
+        save();
+    }
+    return changed;
+}
+
+bool OBSCookieJar::deleteCookie(const QNetworkCookie &cookie)
+{
+    bool deleted = QNetworkCookieJar::deleteCookie(cookie);
+    if (deleted) {
+        save();
+    }
+    return deleted;
+}
+
+void OBSCookieJar::clear()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+    setAllCookies(QList<QNetworkCookie>());
+    QFile::remove(m_fileName);
+}
+
+void OBSCookieJar::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setAllCookies(QList<QNetworkCookie>());
+        return;
+    }
+
+    QList<QNetworkCookie> cookies;
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        for (const QNetworkCookie &cookie : QNetworkCookie::parseCookies(line)) {
+            if (cookie.isSessionCookie() || cookie.expirationDate() > now) {
+                cookies.append(cookie);
+            }
+        }
+    }
+    file.close();
+
+    qDebug() << __PRETTY_FUNCTION__ << "Loaded" << cookies.size() << "cookies";
+    setAllCookies(cookies);
+}
+
+void OBSCookieJar::save()
+{
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << __PRETTY_FUNCTION__ << "Cannot write" << m_fileName << file.errorString();
+        return;
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    for (const QNetworkCookie &cookie : allCookies()) {
+        file.write(cookie.toRawForm(QNetworkCookie::Full));
+        file.write("\n");
+    }
+    file.commit();
+}
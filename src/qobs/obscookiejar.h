@@ -0,0 +1,53 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSCOOKIEJAR_H
+#define OBSCOOKIEJAR_H
+
+#include <QNetworkCookieJar>
+#include <QNetworkCookie>
+#include <QUrl>
+
+/*
+ * OBSCookieJar keeps the cookies set by the API, session cookies included,
+ * in a file, so that the server session is reused across restarts instead
+ * of authenticating every request again. The file is rewritten whenever the
+ * server changes a cookie. Each user has a file of their own.
+ *
+ */
+class OBSCookieJar : public QNetworkCookieJar
+{
+    Q_OBJECT
+
+public:
+    explicit OBSCookieJar(const QString &fileName = QString(), QObject *parent = nullptr);
+    QString getFileName() const;
+    void setFileName(const QString &fileName);
+    bool setCookiesFromUrl(const QList<QNetworkCookie> &cookieList, const QUrl &url) override;
+    bool deleteCookie(const QNetworkCookie &cookie) override;
+    void clear();
+
+private:
+    QString m_fileName;
+    void load();
+    void save();
+};
+
+#endif // OBSCOOKIEJAR_H
@@ -21,9 +21,28 @@
 
 #include "obscore.h"
 #include "obsstatus.h"
+#include <QRandomGenerator>
+#include <QDateTime>
+#include <QtMath>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include "obsxmlwriter.h"
+#include "obscpioextractor.h"
+#include "obsmd5task.h"
 
 OBSCore *OBSCore::instance = nullptr;
 const QString userAgent = APP_NAME + QString(" ") + QACTUS_VERSION;
+const int maxRetries = 3;
+const int retryBaseDelay = 1000;
+const int maxRetryDelay = 60000;
+static const quint32 sslSessionFormatVersion = 1;
+static const qint64 streamBufferSize = 1024 * 1024;
 
 OBSCore::OBSCore()
 {
@@ -32,12 +51,111 @@ OBSCore::OBSCore()
     manager = nullptr;
     includeHomeProjects = false;
     linkHelper = nullptr;
+    networkThread = nullptr;
+    sessionGeneration = 0;
+    http2Enabled = false;
+    http2Unavailable = false;
+    http2Replies = 0;
+    http1Replies = 0;
+    scheduler = new OBSRequestScheduler(this);
+    connect(scheduler, &OBSRequestScheduler::burstFinished, this, [this]() {
+        qDebug() << "OBSCore: burst served over HTTP/2:" << http2Replies << "HTTP/1.1:" << http1Replies;
+        http2Replies = 0;
+        http1Replies = 0;
+    });
+    circuitBreaker = new OBSCircuitBreaker(this);
+    cookieJar = new OBSCookieJar(cookieFileName(), this);
+    connect(circuitBreaker, &OBSCircuitBreaker::stateChanged, this, [this](OBSCircuitBreaker::State state) {
+        // Monitor and request box polling waits while the API is degraded
+        scheduler->setPaused(OBSRequestScheduler::Background, state == OBSCircuitBreaker::Open);
+    });
+    diskCache = new OBSDiskCache();
+    blobStore = new OBSBlobStore();
+
+    OBSXmlReader::registerMetaTypes();
+    qRegisterMetaType<OBSRequestHandle>("OBSRequestHandle");
+    parserThread = new QThread(this);
+    parserThread->setObjectName("OBSParser");
+    parserWorker = new QObject();
+    parserWorker->moveToThread(parserThread);
+    connect(parserThread, &QThread::finished, parserWorker, &QObject::deleteLater);
+    if (QCoreApplication::instance()) {
+        // Direct, OBSCore may live in the network thread, which is stopped here
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+            if (networkThread) {
+                networkThread->quit();
+                networkThread->wait();
+            }
+            parserThread->quit();
+            parserThread->wait();
+        }, Qt::DirectConnection);
+    }
+    parserThread->start();
+}
+
+void OBSCore::startNetworkThread()
+{
+    // Must be called from the GUI thread before sending any request
+    if (networkThread) {
+        return;
+    }
+    qDebug() << "OBSCore::startNetworkThread()";
+    networkThread = new QThread();
+    networkThread->setObjectName("OBSNetwork");
+    moveToThread(networkThread);
+    networkThread->start();
+}
+
+bool OBSCore::isNetworkThreadRunning() const
+{
+    return networkThread != nullptr;
+}
+
+bool OBSCore::invokeInNetworkThread(const std::function<void ()> &call)
+{
+    if (QThread::currentThread() == thread()) {
+        return false;
+    }
+    QMetaObject::invokeMethod(this, call, Qt::QueuedConnection);
+    return true;
+}
+
+void OBSCore::parse(const std::function<void (OBSXmlReader *)> &job)
+{
+    OBSXmlReader *hub = xmlReader;
+    QMetaObject::invokeMethod(parserWorker, [job, hub]() {
+        OBSXmlReader reader;
+        reader.forwardSignalsTo(hub);
+        job(&reader);
+    }, Qt::QueuedConnection);
+}
+
+void OBSCore::parse(const std::function<void (OBSXmlReader *)> &job, const OBSRequestHandle &handle)
+{
+    parse([job, handle](OBSXmlReader *reader) {
+        // Superseded while waiting for the parser thread
+        if (handle.isCancelled()) {
+            return;
+        }
+        job(reader);
+    });
+}
+
+QNetworkAccessManager *OBSCore::getManager()
+{
+    if (!manager) {
+        createManager();
+    }
+    return manager;
 }
 
 void OBSCore::createManager()
 {
     qDebug() << "OBSCore::createManager()";
     manager = new QNetworkAccessManager(this);
+    manager->setCookieJar(cookieJar);
+    cookieJar->setParent(this);
+    connect(manager, &QNetworkAccessManager::encrypted, this, &OBSCore::storeSslSession);
     connect(manager, SIGNAL(authenticationRequired(QNetworkReply*,QAuthenticator*)),
             SLOT(provideAuthentication(QNetworkReply*,QAuthenticator*)));
     connect(manager, SIGNAL(finished(QNetworkReply*)), this, SLOT(replyFinished(QNetworkReply*)));
@@ -55,16 +173,70 @@ OBSCore *OBSCore::getInstance()
 
 void OBSCore::setCredentials(const QString& username, const QString& password)
 {
-    qDebug() << "OBSCore::setCredentials()";
-//    Allow login with another username/password
-    if (manager!=nullptr) {
-        delete manager;
-        manager = nullptr;
-    }
-    createManager();
-
+    // Stored at once, getUsername() is often called right after this
+    QMutexLocker locker(&mutex);
     curUsername = username;
     curPassword = password;
+    locker.unlock();
+
+    if (invokeInNetworkThread([this]() {
+        resetSession();
+    })) {
+        return;
+    }
+    resetSession();
+}
+
+void OBSCore::resetSession()
+{
+    qDebug() << "OBSCore::resetSession()";
+    // Allow login with another username/password. The manager is kept, with
+    // its warm connections; only the replies of the old session go away.
+    QList<QNetworkReply *> replies = requestContexts.keys();
+    for (QNetworkReply *reply : replies) {
+        discardedReplies.insert(reply);
+        reply->abort();
+    }
+
+    QString username = getUsername();
+    if (manager && username != sessionUsername) {
+        // Credentials cached by QNAM belong to the previous user
+        manager->clearAccessCache();
+    }
+    sessionUsername = username;
+
+    sessionGeneration++;
+    requestContexts.clear();
+    qDeleteAll(streamedBodies);
+    streamedBodies.clear();
+    timedOutReplies.clear();
+    inFlightGets.clear();
+    inFlightHandles.clear();
+    resourceCache.clear();
+    projectLists.clear();
+    packageLists.clear();
+    scheduler->clear();
+    circuitBreaker->reset();
+    cookieJar->setFileName(cookieFileName());
+    getManager();
+    emit sessionReset();
+}
+
+QString OBSCore::cookieFileName() const
+{
+    // One session per user and server
+    QString id = getApiUrl() + " " + getUsername();
+    QByteArray hash = QCryptographicHash::hash(id.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/cookies/" + QString::fromLatin1(hash);
+}
+
+QByteArray OBSCore::authorizationHeader() const
+{
+    QMutexLocker locker(&mutex);
+    if (curUsername.isEmpty()) {
+        return QByteArray();
+    }
+    return "Basic " + QString("%1:%2").arg(curUsername, curPassword).toUtf8().toBase64();
 }
 
 void OBSCore::slotLinkPackage(const QString &dstProject, const QString &dstPackage, const QByteArray &data)
@@ -72,10 +244,24 @@ void OBSCore::slotLinkPackage(const QString &dstProject, const QString &dstPacka
     qDebug() << __PRETTY_FUNCTION__;
     QString resource = QString("/source/%1/%2/_link").arg(dstProject, dstPackage);
 
-    QNetworkReply *reply = putRequest(resource, data);
-    reply->setProperty("reqtype", OBSCore::LinkPackage);
-    reply->setProperty("destprj", dstProject);
-    reply->setProperty("destpkg", dstPackage);
+    RequestContext context(OBSCore::LinkPackage);
+    context.onSuccess = [this, dstProject, dstPackage](const QByteArray &data) {
+        parse([dstProject, dstPackage, data](OBSXmlReader *reader) {
+            reader->parseLinkPackage(dstProject, dstPackage, data);
+        });
+    };
+    context.onNotFound = [this, dstProject, dstPackage](const QByteArray &) {
+        OBSStatus *status = new OBSStatus();
+        QString details = QString("The package %2 in project %1 does NOT exist.").arg(dstProject, dstPackage);
+        status->setDetails(details);
+        status->setSummary("Cannot link");
+        status->setCode("error");
+        status->setProject(dstProject);
+        status->setPackage(dstPackage);
+
+        emit cannotLinkPackage(status);
+    };
+    putRequest(resource, data, context);
 
     if (linkHelper) {
         delete linkHelper;
@@ -83,825 +269,1493 @@ void OBSCore::slotLinkPackage(const QString &dstProject, const QString &dstPacka
     }
 }
 
-QString OBSCore::getUsername()
+QString OBSCore::getUsername() const
 {
+    QMutexLocker locker(&mutex);
     return curUsername;
 }
 
 void OBSCore::setApiUrl(const QString &apiUrl)
 {
+    QMutexLocker locker(&mutex);
+    bool changed = (this->apiUrl != apiUrl);
     this->apiUrl = apiUrl;
+    locker.unlock();
+
+    // Connect while the credentials are being read and the user logs in
+    if (changed) {
+        prewarmConnection();
+    }
 }
 
-QString OBSCore::getApiUrl() const
+void OBSCore::prewarmConnection()
 {
-    return apiUrl;
+    if (invokeInNetworkThread([this]() {
+        prewarmConnection();
+    })) {
+        return;
+    }
+
+    QUrl url(getApiUrl());
+    if (!url.isValid() || url.host().isEmpty()) {
+        return;
+    }
+    qDebug() << "OBSCore::prewarmConnection()" << url.host();
+
+    if (url.scheme() == "https") {
+        loadSslSession(url);
+        getManager()->connectToHostEncrypted(url.host(), quint16(url.port(443)), sslConfiguration());
+    } else {
+        getManager()->connectToHost(url.host(), quint16(url.port(80)));
+    }
 }
 
-void OBSCore::login()
+bool OBSCore::isHttp2Enabled() const
 {
-    QNetworkReply *reply = request("/");
-    reply->setProperty("reqtype", OBSCore::Login);
+    QMutexLocker locker(&mutex);
+    return http2Enabled;
 }
 
-QNetworkReply *OBSCore::request(const QString &resource)
+void OBSCore::setHttp2Enabled(bool enabled)
 {
-    QNetworkRequest request;
-    request.setUrl(QUrl(apiUrl + resource));
-    qDebug() << "User-Agent:" << userAgent;
-    request.setRawHeader("User-Agent", userAgent.toLatin1());  
-    QNetworkReply *reply = manager->get(request);
-    return reply;
+    if (invokeInNetworkThread([this, enabled]() {
+        setHttp2Enabled(enabled);
+    })) {
+        return;
+    }
+    qDebug() << "OBSCore::setHttp2Enabled()" << enabled;
+    QMutexLocker locker(&mutex);
+    http2Enabled = enabled;
+    // Give HTTP/2 another chance after a fallback
+    http2Unavailable = false;
 }
 
-void OBSCore::request(QNetworkReply *reply)
+void OBSCore::setMaxConnections(int maxConnections)
 {
-    QString resource = reply->url().toString();
-    QNetworkReply *newReply = request(resource);
-    newReply->setProperty("reqtype", reply->property("reqtype"));
-
-    if (reply->property("row").isValid()) {
-        newReply->setProperty("row", reply->property("row").toInt());
+    if (invokeInNetworkThread([this, maxConnections]() {
+        setMaxConnections(maxConnections);
+    })) {
+        return;
     }
+    // QNAM opens up to six HTTP/1.1 connections per host, more requests in
+    // flight only make sense with HTTP/2
+    qDebug() << "OBSCore::setMaxConnections()" << maxConnections;
+    scheduler->setMaxInFlight(maxConnections);
 }
 
-QNetworkReply *OBSCore::requestBuild(const QString &resource)
+void OBSCore::allowHttp2(QNetworkRequest &request) const
 {
-    return request("/build/" + resource);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, isHttp2Enabled() && !http2Unavailable);
 }
 
-void OBSCore::getBuildStatus(const QStringList &build, int row)
+bool OBSCore::isHttp2Failure(QNetworkReply *reply)
 {
-    QString resource = QString("%1/%2/%3/%4/_status").arg(build[0], build[1], build[2], build[3]);
-    QNetworkReply *reply = requestBuild(resource);
-    reply->setProperty("reqtype", OBSCore::BuildStatus);
-    reply->setProperty("row", row);
+    // Servers or proxies that break on the HTTP/2 upgrade or ALPN
+    return reply->request().attribute(QNetworkRequest::Http2AllowedAttribute).toBool() &&
+            reply->error() == QNetworkReply::ProtocolFailure;
 }
 
-QNetworkReply *OBSCore::requestSource(const QString &resource)
+QSslConfiguration OBSCore::sslConfiguration() const
 {
-    return request("/source" + resource);
+    QSslConfiguration configuration = QSslConfiguration::defaultConfiguration();
+    // Needed for sessionTicket() to be available after the handshake
+    configuration.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    if (!sslSessionTicket.isEmpty()) {
+        configuration.setSessionTicket(sslSessionTicket);
+    }
+    return configuration;
 }
 
-QString OBSCore::createReqResourceStr(const QString &states, const QString &roles) const
+QString OBSCore::sslSessionFileName(const QUrl &url)
 {
-    return  QString("/request/?view=collection&states=%1&roles=%2&user=%3")
-            .arg(states).arg(roles).arg(curUsername);
+    QString id = QString("%1:%2").arg(url.host()).arg(url.port(443));
+    QByteArray hash = QCryptographicHash::hash(id.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/tlssessions/" + QString::fromLatin1(hash);
 }
 
-void OBSCore::getRequests(OBSCore::RequestType type)
+void OBSCore::loadSslSession(const QUrl &url)
 {
-    QString resource;
-    QNetworkReply *reply = nullptr;
-
-    switch (type) {
-    case OBSCore::IncomingRequests:
-        resource = createReqResourceStr("new", "maintainer");
-        reply = request(resource);
-        break;
-    case OBSCore::OutgoingRequests:
-        resource = createReqResourceStr("new", "creator");
-        reply = request(resource);
-        break;
-    case OBSCore::DeclinedRequests:
-        resource = createReqResourceStr("declined", "creator");
-        reply = request(resource);
-        break;
-    default:
-        qDebug() << " OBSCore::getRequests() request type not handled!";
-        break;
+    if (sslSessionHost == url.host()) {
+        return;
     }
+    sslSessionHost = url.host();
+    sslSessionTicket.clear();
 
-    if (reply) {
-        reply->setProperty("reqtype", type);
+    QFile file(sslSessionFileName(url));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
     }
+    QDataStream stream(&file);
+    quint32 version;
+    QDateTime expires;
+    QByteArray ticket;
+    stream >> version >> expires >> ticket;
+    file.close();
+
+    if (version != sslSessionFormatVersion || stream.status() != QDataStream::Ok ||
+            expires < QDateTime::currentDateTimeUtc()) {
+        qDebug() << "OBSCore::loadSslSession() Discarding stale TLS session";
+        file.remove();
+        return;
+    }
+    sslSessionTicket = ticket;
 }
 
-void OBSCore::getIncomingRequests()
+void OBSCore::storeSslSession(QNetworkReply *reply)
 {
-    getRequests(OBSCore::IncomingRequests);
+    QSslConfiguration configuration = reply->sslConfiguration();
+    QByteArray ticket = configuration.sessionTicket();
+    if (ticket.isEmpty() || ticket == sslSessionTicket) {
+        return;
+    }
+    sslSessionHost = reply->url().host();
+    sslSessionTicket = ticket;
+
+    // The session holds the TLS secrets, keep it private
+    QString fileName = sslSessionFileName(reply->url());
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    int lifetime = configuration.sessionTicketLifeTimeHint();
+    QDateTime expires = QDateTime::currentDateTimeUtc().addSecs(lifetime > 0 ? lifetime : 7200);
+    QDataStream stream(&file);
+    stream << sslSessionFormatVersion << expires << ticket;
+    file.commit();
+    qDebug() << "OBSCore::storeSslSession() TLS session stored for" << reply->url().host();
 }
 
-void OBSCore::getOutgoingRequests()
+QString OBSCore::getApiUrl() const
 {
-    getRequests(OBSCore::OutgoingRequests);
+    QMutexLocker locker(&mutex);
+    return apiUrl;
 }
 
-void OBSCore::getDeclinedRequests()
+void OBSCore::login()
 {
-    getRequests(OBSCore::DeclinedRequests);
+    if (invokeInNetworkThread([this]() {
+        login();
+    })) {
+        return;
+    }
+    QUrl url(getApiUrl() + "/");
+    RequestContext context(OBSCore::Login);
+    context.onSuccess = [](const QByteArray &) {
+        // <html>, nothing to parse
+    };
+    context.onNotFound = [this, url](const QByteArray &) {
+        qDebug() << "OBSCore::login() OBS API not found at" << url.toString();
+        emit apiNotFound(url);
+    };
+    request("/", context);
 }
 
-bool OBSCore::isIncludeHomeProjects() const
+QNetworkRequest OBSCore::createNetworkRequest(const QString &resource) const
 {
-    return includeHomeProjects;
+    QNetworkRequest request;
+    request.setUrl(QUrl(getApiUrl() + resource));
+    request.setRawHeader("User-Agent", userAgent.toLatin1());
+    if (request.url().scheme() == "https") {
+        request.setSslConfiguration(sslConfiguration());
+    }
+    allowHttp2(request);
+
+    // Sent with every request, instead of waiting for a 401 challenge
+    QByteArray authorization = authorizationHeader();
+    if (!authorization.isEmpty()) {
+        request.setRawHeader("Authorization", authorization);
+    }
+    return request;
 }
 
-void OBSCore::setIncludeHomeProjects(bool value)
+OBSRequestScheduler *OBSCore::getRequestScheduler() const
 {
-    includeHomeProjects = value;
+    return scheduler;
 }
 
-void OBSCore::getProjects()
+OBSBlobStore *OBSCore::getBlobStore() const
 {
-    QNetworkReply *reply = requestSource("");
-    reply->setProperty("reqtype", OBSCore::ProjectList);
-    QString userHome = includeHomeProjects ? "" : "home:" + curUsername;
-    reply->setProperty("includehomeprjs", userHome);
+    return blobStore;
 }
 
-void OBSCore::getProjectMetaConfig(const QString &resource)
+OBSCircuitBreaker *OBSCore::getCircuitBreaker() const
 {
-    QNetworkReply *reply = requestSource(resource);
-    reply->setProperty("reqtype", OBSCore::PrjMetaConfig);
+    return circuitBreaker;
 }
 
-void OBSCore::getPackageMetaConfig(const QString &resource)
+OBSRequestScheduler::Priority OBSCore::priorityForType(RequestType type)
 {
-    QNetworkReply *reply = requestSource(resource);
-    reply->setProperty("reqtype", OBSCore::PkgMetaConfig);
+    switch (type) {
+    case OBSCore::BuildStatus:
+    case OBSCore::IncomingRequests:
+    case OBSCore::OutgoingRequests:
+    case OBSCore::DeclinedRequests:
+    case OBSCore::WatchBuildResults:
+        // Monitor and request box polling
+        return OBSRequestScheduler::Background;
+    case OBSCore::Login:
+    case OBSCore::About:
+    case OBSCore::Person:
+    case OBSCore::Distributions:
+        return OBSRequestScheduler::Normal;
+    default:
+        return OBSRequestScheduler::Interactive;
+    }
 }
 
-void OBSCore::getPackages(const QString &resource)
+void OBSCore::schedule(const OBSRequestScheduler::SendFunction &send)
 {
-    QNetworkReply *reply = requestSource(resource);
-    reply->setProperty("reqtype", OBSCore::PackageList);
+    scheduler->enqueue(send, OBSRequestScheduler::Normal);
 }
 
-void OBSCore::getFiles(const QString &project, const QString &package)
+void OBSCore::schedule(const OBSRequestScheduler::SendFunction &send, const RequestContext &context)
 {
-    QString resource = QString("/%1/%2").arg(project, package);
-    QNetworkReply *reply = requestSource(resource);
-    reply->setProperty("reqtype", OBSCore::FileList);
-    reply->setProperty("prjfile", project);
-    reply->setProperty("pkgfile", package);
+    // Kept for retries
+    RequestContext sentContext(context);
+    sentContext.send = send;
+
+    if (context.longPoll) {
+        registerReply(send(), sentContext);
+        return;
+    }
+
+    scheduler->enqueue([this, send, sentContext]() -> QNetworkReply * {
+        if (sentContext.handle.isCancelled()) {
+            qDebug() << "OBSCore::schedule() Request cancelled before being sent";
+            releaseInFlightGet(sentContext);
+            return nullptr;
+        }
+        QNetworkReply *reply = send();
+        if (reply) {
+            registerReply(reply, sentContext);
+        }
+        return reply;
+    }, priorityForType(context.type));
 }
 
-void OBSCore::getLink(const QString &project, const QString &package)
+int OBSCore::timeoutForType(RequestType type)
 {
-    QString resource = QString("/source/%1/%2/_link").arg(project, package);
-    QNetworkReply *reply = request(resource);
-    reply->setProperty("reqtype", OBSCore::Link);
+    // Time without any data being sent or received
+    switch (type) {
+    case OBSCore::WatchBuildResults:
+        // The server holds long polls for a few minutes
+        return 900000;
+    case OBSCore::BuildLog:
+    case OBSCore::DownloadFile:
+    case OBSCore::DownloadPackage:
+    case OBSCore::DownloadBinaries:
+    case OBSCore::UploadFile:
+    case OBSCore::SRDiff:
+        return 120000;
+    case OBSCore::ProjectList:
+    case OBSCore::BuildStatusList:
+    case OBSCore::BuildStatus:
+        return 60000;
+    default:
+        return 30000;
+    }
 }
 
-void OBSCore::getAllBuildStatus(const QString &resource)
+void OBSCore::registerReply(QNetworkReply *reply, const RequestContext &context)
 {
-    QNetworkReply *reply = requestBuild(resource);
-    reply->setProperty("reqtype", OBSCore::BuildStatusList);
+    requestContexts.insert(reply, context);
+
+    QTimer *timeoutTimer = new QTimer(reply);
+    timeoutTimer->setSingleShot(true);
+    timeoutTimer->setInterval(timeoutForType(context.type));
+    connect(timeoutTimer, &QTimer::timeout, this, [this, reply]() {
+        qDebug() << "OBSCore::registerReply() Request timed out" << reply->url().toString();
+        timedOutReplies.insert(reply);
+        reply->abort();
+    });
+    connect(reply, &QNetworkReply::downloadProgress, timeoutTimer, [timeoutTimer]() {
+        timeoutTimer->start();
+    });
+    connect(reply, &QNetworkReply::uploadProgress, timeoutTimer, [timeoutTimer]() {
+        timeoutTimer->start();
+    });
+    timeoutTimer->start();
+
+    if (context.onReadyRead) {
+        reply->setReadBufferSize(streamBufferSize);
+        connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
+            replyReadyRead(reply);
+        });
+    }
+
+    if (context.onMetaData) {
+        std::function<void(QNetworkReply *)> onMetaData = context.onMetaData;
+        connect(reply, &QNetworkReply::metaDataChanged, this, [onMetaData, reply]() {
+            onMetaData(reply);
+        });
+    }
+
+    if (context.onProgress) {
+        ProgressHandler onProgress = context.onProgress;
+        if (reply->operation() == QNetworkAccessManager::GetOperation) {
+            connect(reply, &QNetworkReply::downloadProgress, this, onProgress);
+        } else {
+            connect(reply, &QNetworkReply::uploadProgress, this, onProgress);
+        }
+    }
 }
 
-void OBSCore::request(const QString &resource, int row)
+void OBSCore::replyReadyRead(QNetworkReply *reply)
 {
-    QNetworkReply *reply = request(resource);
-    reply->setProperty("reqtype", OBSCore::BuildStatus);
-    reply->setProperty("row", row);
+    // Only successful bodies (or parts of them) are streamed, the rest is handled in replyFinished()
+    int httpStatusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    auto it = requestContexts.constFind(reply);
+    if ((httpStatusCode != 200 && httpStatusCode != 206) || it == requestContexts.constEnd() || it->handle.isCancelled()) {
+        return;
+    }
+
+    QByteArray data = reply->readAll();
+    if (it->conditional) {
+        OBSDiskCacheEntry *entry = streamedBodies.value(reply);
+        if (!entry) {
+            entry = new OBSDiskCacheEntry(diskCache, diskCacheKey(it->key),
+                                          reply->rawHeader("ETag"), reply->rawHeader("Last-Modified"));
+            streamedBodies.insert(reply, entry);
+        }
+        entry->append(data);
+    } else {
+        // Just remember that the reply has been streamed
+        streamedBodies.insert(reply, nullptr);
+    }
+    it->onReadyRead(data);
 }
 
-QNetworkReply *OBSCore::postRequest(const QString &resource, const QByteArray &data, const QString &contentTypeHeader)
+QNetworkReply *OBSCore::sendGet(const QNetworkRequest &request)
 {
-    QNetworkRequest request;
-    request.setUrl(QUrl(apiUrl + resource));
-    qDebug() << "User-Agent:" << userAgent;
-    request.setRawHeader("User-Agent", userAgent.toLatin1());
-    request.setHeader(QNetworkRequest::ContentTypeHeader, contentTypeHeader);
-    QNetworkReply *reply = manager->post(request, data);
+    // The request may have been built before falling back to HTTP/1.1
+    QNetworkRequest sentRequest(request);
+    allowHttp2(sentRequest);
+    return getManager()->get(sentRequest);
+}
 
-    return reply;
+void OBSCore::request(const QString &resource)
+{
+    if (invokeInNetworkThread([this, resource]() {
+        request(resource);
+    })) {
+        return;
+    }
+    QNetworkRequest request = createNetworkRequest(resource);
+    schedule([this, request]() {
+        return sendGet(request);
+    });
 }
 
-QNetworkReply *OBSCore::putRequest(const QString &resource, const QByteArray &data)
+void OBSCore::request(const QString &resource, const RequestContext &context)
 {
-    QNetworkRequest request;
-    request.setUrl(QUrl(apiUrl + resource));
-    qDebug() << "User-Agent:" << userAgent;
-    request.setRawHeader("User-Agent", userAgent.toLatin1());
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/xml");
-    QNetworkReply *reply = manager->put(request, data);
+    QNetworkRequest request = createNetworkRequest(resource);
+    for (auto it = context.headers.constBegin(); it != context.headers.constEnd(); ++it) {
+        request.setRawHeader(it.key(), it.value());
+    }
+    QString key = QString("%1 %2 %3").arg(QString::number(context.type), request.url().toString(), context.tag);
+
+    // A request cancelled by all of its waiters is on its way out, don't join it
+    if (inFlightGets.contains(key) && !inFlightHandles.value(key).isCancelled()) {
+        inFlightGets[key]++;
+        OBSRequestHandle inFlight = inFlightHandles.value(key);
+        if (context.handle.isNull()) {
+            inFlight.retain();
+        } else {
+            OBSRequestHandle waiter(context.handle);
+            waiter.join(inFlight);
+        }
+        qDebug() << "OBSCore::request() Coalescing with in-flight request" << request.url().toString();
+        return;
+    }
+    inFlightGets.insert(key, 1);
+    if (context.handle.isNull()) {
+        inFlightHandles.remove(key);
+    } else {
+        inFlightHandles.insert(key, context.handle);
+    }
 
-    return reply;
+    RequestContext keyedContext(context);
+    keyedContext.key = key;
+
+    if (context.conditional && !resourceCache.contains(key)) {
+        OBSCachedResponse cached;
+        if (diskCache->read(diskCacheKey(key), cached)) {
+            // Show the cached result now, the reply will revalidate it
+            if (context.onSuccess) {
+                qDebug() << "OBSCore::request() Using cached response for" << request.url().toString();
+                keyedContext.servedStale = true;
+                ReplyHandler onSuccess = context.onSuccess;
+                QByteArray data = cached.data;
+                QTimer::singleShot(0, this, [onSuccess, data]() {
+                    onSuccess(data);
+                });
+            }
+            if (context.onNotModified) {
+                cached.data.clear();
+            }
+            resourceCache.insert(key, cached);
+        }
+    }
+
+    if (context.conditional && resourceCache.contains(key)) {
+        const OBSCachedResponse &cached = resourceCache[key];
+        if (!cached.etag.isEmpty()) {
+            request.setRawHeader("If-None-Match", cached.etag);
+        }
+        if (!cached.lastModified.isEmpty()) {
+            request.setRawHeader("If-Modified-Since", cached.lastModified);
+        }
+    }
+    schedule([this, request]() {
+        return sendGet(request);
+    }, keyedContext);
 }
 
-QNetworkReply *OBSCore::deleteRequest(const QString &resource)
+void OBSCore::request(QNetworkReply *reply)
 {
-    QNetworkRequest request;
-    request.setUrl(QUrl(apiUrl + resource));
-    request.setRawHeader("User-Agent", userAgent.toLatin1());
-    QNetworkReply *reply = manager->deleteResource(request);
-
-    return reply;
+    // Called by the selfSignedCertificate() handler
+    if (invokeInNetworkThread([this, reply]() {
+        request(reply);
+    })) {
+        return;
+    }
+    // A held reply is sent again by answerSelfSignedCertificate()
+    if (heldReplies.contains(reply)) {
+        return;
+    }
+    resend(reply->request(), requestContexts.contains(reply), requestContexts.value(reply));
 }
 
-void OBSCore::changeSubmitRequest(const QString &resource, const QByteArray &data)
+void OBSCore::answerSelfSignedCertificate(QNetworkReply *reply, bool accepted)
 {
-    QNetworkReply *reply = postRequest(resource, data, "application/x-www-form-urlencoded");
-    reply->setProperty("reqtype", OBSCore::ChangeRequestState);
+    if (invokeInNetworkThread([this, reply, accepted]() {
+        answerSelfSignedCertificate(reply, accepted);
+    })) {
+        return;
+    }
+    if (!heldReplies.remove(reply)) {
+        return;
+    }
+
+    if (accepted && !discardedReplies.contains(reply)) {
+        qDebug() << "OBSCore::answerSelfSignedCertificate() Sending again" << reply->url().toString();
+        bool hasContext = requestContexts.contains(reply);
+        resend(reply->request(), hasContext, requestContexts.take(reply));
+        reply->deleteLater();
+        return;
+    }
+    // Reports the failed handshake, or drops a reply of a previous session
+    replyFinished(reply);
 }
 
-void OBSCore::provideAuthentication(QNetworkReply *reply, QAuthenticator *ator)
+void OBSCore::resend(const QNetworkRequest &request, bool hasContext, const RequestContext &context)
 {
-    qDebug() << "OBSCore::provideAuthentication() for" << reply->request().url().toString();
-//    qDebug() << reply->readAll();
+    OBSRequestScheduler::SendFunction send = [this, request]() {
+        return sendGet(request);
+    };
 
-    if ((curPassword != prevPassword) || (curUsername != prevUsername)) {
-        prevPassword = curPassword;
-        prevUsername = curUsername;
-        ator->setUser(curUsername);
-        ator->setPassword(curPassword);
+    if (hasContext) {
+        schedule(send, context);
     } else {
-        qDebug() << "OBSCore::provideAuthentication() same credentials provided!";
-        // FIXME: Workaround to accept the same credentials
-        // Not calling ator->setUser() or ator->setPassword() results in a signal
-        // being emitted with a QNetworkReply with error AuthenticationRequiredError.
-        // So, first time auth with same credentials fails, second time doesn't.
-        // If we call ator->setUser()/ator->setPassword() directly (no if) with the
-        // correct username and wrong password, it ends up in an infinite loop and
-        // probably a blocked openSUSE account :-(
-        prevUsername = "";
-        prevPassword = "";
+        schedule(send);
     }
 }
 
-bool OBSCore::isAuthenticated()
+void OBSCore::requestBuild(const QString &resource)
 {
-    return authenticated;
+    if (invokeInNetworkThread([this, resource]() {
+        requestBuild(resource);
+    })) {
+        return;
+    }
+    request("/build/" + resource);
 }
 
-void OBSCore::replyFinished(QNetworkReply *reply)
+void OBSCore::requestBuild(const QString &resource, const RequestContext &context)
 {
-    // QNetworkReply is a sequential-access QIODevice, which means that
-    // once data is read from the object, it no longer kept by the device.
-    // It is therefore the application's responsibility to keep this data if it needs to.
-    // See http://doc.qt.nokia.com/latest/qnetworkreply.html for more info
-    QByteArray data = reply->readAll();
+    request("/build/" + resource, context);
+}
 
-    qDebug() << "OBSCore::replyFinished()" << reply->url().toString();
-    int httpStatusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    qDebug() << "OBSCore::replyFinished() HTTP status code:" << httpStatusCode;
-//    qDebug() << "Network Reply: " << data;
+OBSCore::RequestContext OBSCore::buildStatusContext(int row)
+{
+    RequestContext context(OBSCore::BuildStatus);
+    context.onSuccess = [this, row](const QByteArray &data) {
+        parse([row, data](OBSXmlReader *reader) {
+            reader->setPackageRow(row);
+            reader->parseBuildStatus(data);
+        });
+    };
+    context.tag = QString::number(row);
+    context.onNotFound = [this, row](const QByteArray &data) {
+        // <status>
+        if (isAuthenticated()) {
+            parse([row, data](OBSXmlReader *reader) {
+                reader->setPackageRow(row);
+                reader->parseBuildStatus(data);
+            });
+        }
+    };
+    return context;
+}
 
-    if (httpStatusCode==302) {
-        authenticated = true;
-        emit isAuthenticated(authenticated);
-    } else if (httpStatusCode==401) {
-        authenticated = false;
-        emit isAuthenticated(authenticated);
+void OBSCore::getBuildStatus(const QStringList &build, int row)
+{
+    if (invokeInNetworkThread([this, build, row]() {
+        getBuildStatus(build, row);
+    })) {
+        return;
     }
+    QString resource = QString("%1/%2/%3/%4/_status").arg(build[0], build[1], build[2], build[3]);
+    requestBuild(resource, buildStatusContext(row));
+}
 
-    /* Set package row always (error/no error) if property is valid.
-     * Needed for inserting the build status
-     */
-    if(reply->property("row").isValid()) {
-        int row = reply->property("row").toInt();
-        qDebug() << "Reply row property:" << QString::number(row);
-        xmlReader->setPackageRow(row);
+void OBSCore::getProjectBuildStatus(const QString &project, const QList<QStringList> &builds, const QList<int> &rows)
+{
+    if (invokeInNetworkThread([this, project, builds, rows]() {
+        getProjectBuildStatus(project, builds, rows);
+    })) {
+        return;
     }
+    // builds: repository, arch, package
+    QMultiHash<QString, int> rowsByBuild;
+    QStringList packages;
+    QStringList repositories;
+    QStringList archs;
+    QStringList rowList;
+
+    for (int i=0; i<builds.size(); i++) {
+        const QStringList &build = builds.at(i);
+        rowsByBuild.insert(build.join("/"), rows.at(i));
+        repositories.append(build[0]);
+        archs.append(build[1]);
+        packages.append(build[2]);
+        rowList.append(QString::number(rows.at(i)));
+    }
+    packages.removeDuplicates();
+    repositories.removeDuplicates();
+    archs.removeDuplicates();
 
-    QString reqTypeStr = "RequestType";
-
-    switch (reply->error()) {
-
-    case QNetworkReply::NoError: {
-        qDebug() << "OBSCore::replyFinished() Request succeeded! Status code:" << httpStatusCode;
-
-        if (reply->property("reqtype").isValid()) {
-            QString reqTypeStr = "RequestType";
-            int reqType = reply->property("reqtype").toInt();
-
-            QString dataStr;
-            if (reqType != OBSCore::DownloadFile) {
-                dataStr = QString::fromUtf8(data);
+    QStringList query;
+    for (const QString &package : packages) {
+        query.append("package=" + QString::fromLatin1(QUrl::toPercentEncoding(package)));
+    }
+    for (const QString &repository : repositories) {
+        query.append("repository=" + QString::fromLatin1(QUrl::toPercentEncoding(repository)));
+    }
+    for (const QString &arch : archs) {
+        query.append("arch=" + QString::fromLatin1(QUrl::toPercentEncoding(arch)));
+    }
+    QString resource = QString("%1/_result?%2").arg(project, query.join("&"));
+
+    RequestContext context(OBSCore::BuildStatus);
+    context.tag = rowList.join(",");
+    context.onSuccess = [this, project, rowsByBuild](const QByteArray &data) {
+        // <resultlist>
+        parse([this, project, rowsByBuild, data](OBSXmlReader *reader) {
+            QList<int> missingRows = reader->parseProjectBuildStatus(project, rowsByBuild, data);
+            if (missingRows.isEmpty()) {
+                return;
             }
 
-            switch(reqType) {
-
-            case OBSCore::Login: // <html>
-                qDebug() << reqTypeStr << "Login";
-                // do nothing
-                break;
-
-            case OBSCore::ProjectList: { // <directory>
-                qDebug() << reqTypeStr << "ProjectList";
-                QString userHome;
-                if (reply->property("includehomeprjs").isValid()) {
-                    userHome = reply->property("includehomeprjs").toString();
+            // Not in the result list (e.g. wrong repository, malformed reply), ask for the status of each build
+            QMetaObject::invokeMethod(this, [this, project, rowsByBuild, missingRows]() {
+                for (int row : missingRows) {
+                    QStringList build = rowsByBuild.key(row).split("/");
+                    getBuildStatus(QStringList() << project << build, row);
                 }
-                xmlReader->parseProjectList(userHome, dataStr);
-                break;
-            }
-
-            case OBSCore::PrjMetaConfig: // <project>
-                qDebug() << reqTypeStr << "PrjMetaConfig";
-                xmlReader->parsePrjMetaConfig(dataStr);
-                break;
-
-            case OBSCore::PkgMetaConfig: // <package>
-                qDebug() << reqTypeStr << "PkgMetaConfig";
-                xmlReader->parsePkgMetaConfig(dataStr);
-                break;
+            }, Qt::QueuedConnection);
+        });
+    };
+    context.onNotFound = [this, project, rowsByBuild](const QByteArray &) {
+        // One missing package or repository fails the whole batch, find out which rows it is
+        for (int row : rowsByBuild.values()) {
+            QStringList build = rowsByBuild.key(row).split("/");
+            getBuildStatus(QStringList() << project << build, row);
+        }
+    };
+    requestBuild(resource, context);
+}
 
-            case OBSCore::PackageList: // <directory>
-                qDebug() << reqTypeStr << "PackageList";
-                xmlReader->parsePackageList(dataStr);
-                break;
+void OBSCore::requestSource(const QString &resource)
+{
+    if (invokeInNetworkThread([this, resource]() {
+        requestSource(resource);
+    })) {
+        return;
+    }
+    request("/source" + resource);
+}
 
-            case OBSCore::FileList: { // <directory>
-                qDebug() << reqTypeStr << "FileList";
-                QString project;
-                QString package;
-                if (reply->property("prjfile").isValid()) {
-                    project = reply->property("prjfile").toString();
-                }
-                if (reply->property("pkgfile").isValid()) {
-                    package = reply->property("pkgfile").toString();
-                }
-                xmlReader->parseFileList(project, package, dataStr);
-                break;
-            }
+void OBSCore::requestSource(const QString &resource, const RequestContext &context)
+{
+    request("/source" + resource, context);
+}
 
-            case OBSCore::Link: { // <link>
-                qDebug() << reqTypeStr << "Link";
-                xmlReader->parseLink(dataStr);
-                break;
-            }
+QString OBSCore::createReqResourceStr(const QString &states, const QString &roles) const
+{
+    return  QString("/request/?view=collection&states=%1&roles=%2&user=%3")
+            .arg(states).arg(roles).arg(getUsername());
+}
 
-            case OBSCore::BuildStatus: // <status>
-                qDebug() << reqTypeStr << "BuildStatus";
-                xmlReader->parseBuildStatus(dataStr);
-                break;
+void OBSCore::getRequests(OBSCore::RequestType type)
+{
+    RequestContext context(type);
+    context.conditional = true;
 
-            case OBSCore::BuildStatusList: // <resultlist>
-                qDebug() << reqTypeStr << "BuildStatusList";
-                xmlReader->parseResultList(dataStr);
-                break;
+    switch (type) {
+    case OBSCore::IncomingRequests: // <collection>
+        context.onSuccess = [this](const QByteArray &data) {
+            parse([data](OBSXmlReader *reader) {
+                reader->parseIncomingRequests(data);
+            });
+        };
+        request(createReqResourceStr("new", "maintainer"), context);
+        break;
+    case OBSCore::OutgoingRequests: // <collection>
+        context.onSuccess = [this](const QByteArray &data) {
+            parse([data](OBSXmlReader *reader) {
+                reader->parseOutgoingRequests(data);
+            });
+        };
+        request(createReqResourceStr("new", "creator"), context);
+        break;
+    case OBSCore::DeclinedRequests: // <collection>
+        context.onSuccess = [this](const QByteArray &data) {
+            parse([data](OBSXmlReader *reader) {
+                reader->parseDeclinedRequests(data);
+            });
+        };
+        request(createReqResourceStr("declined", "creator"), context);
+        break;
+    default:
+        qDebug() << " OBSCore::getRequests() request type not handled!";
+        break;
+    }
+}
 
-            case OBSCore::IncomingRequests: // <collection>
-                qDebug() << reqTypeStr << "Collection";
-                xmlReader->parseIncomingRequests(dataStr);
-                break;
+void OBSCore::getIncomingRequests()
+{
+    if (invokeInNetworkThread([this]() {
+        getIncomingRequests();
+    })) {
+        return;
+    }
+    getRequests(OBSCore::IncomingRequests);
+}
 
-            case OBSCore::OutgoingRequests: // <collection>
-                qDebug() << reqTypeStr << "Collection";
-                xmlReader->parseOutgoingRequests(dataStr);
-                break;
+void OBSCore::getOutgoingRequests()
+{
+    if (invokeInNetworkThread([this]() {
+        getOutgoingRequests();
+    })) {
+        return;
+    }
+    getRequests(OBSCore::OutgoingRequests);
+}
 
-            case OBSCore::DeclinedRequests: // <collection>
-                qDebug() << reqTypeStr << "Collection";
-                xmlReader->parseDeclinedRequests(dataStr);
-                break;
+void OBSCore::getDeclinedRequests()
+{
+    if (invokeInNetworkThread([this]() {
+        getDeclinedRequests();
+    })) {
+        return;
+    }
+    getRequests(OBSCore::DeclinedRequests);
+}
 
-            case OBSCore::ChangeRequestState:
-                qDebug() << reqTypeStr << "ChangeRequestState";
-                xmlReader->parseRequestStatus(dataStr);
-                break;
+bool OBSCore::isIncludeHomeProjects() const
+{
+    QMutexLocker locker(&mutex);
+    return includeHomeProjects;
+}
 
-            case OBSCore::SRDiff:
-                qDebug() << reqTypeStr << "SRDiff";
-                emit srDiffFetched(dataStr);
-                break;
+void OBSCore::setIncludeHomeProjects(bool value)
+{
+    QMutexLocker locker(&mutex);
+    includeHomeProjects = value;
+}
 
-            case OBSCore::BranchPackage: {
-                qDebug() << reqTypeStr << "BranchPackage";
-                QString project;
-                QString package;
-                if (reply->property("branchprj").isValid()) {
-                    project = reply->property("branchprj").toString();
-                }
-                if (reply->property("branchpkg").isValid()) {
-                    package = reply->property("branchpkg").toString();
-                }
-                xmlReader->parseBranchPackage(project, package, dataStr);
-                break;
-            }
+void OBSCore::getProjects()
+{
+    if (invokeInNetworkThread([this]() {
+        getProjects();
+    })) {
+        return;
+    }
+    QString userHome = isIncludeHomeProjects() ? "" : "home:" + getUsername();
+    RequestContext context(OBSCore::ProjectList);
+    context.tag = userHome;
+    context.conditional = true;
+    QSharedPointer<OBSListParser> parser(new OBSListParser(userHome));
+    // The parser is only used on the parser thread, which runs jobs in order
+    context.onReadyRead = [this, parser](const QByteArray &data) {
+        // <directory>
+        parse([parser, data](OBSXmlReader *reader) {
+            reader->parseProjectListData(parser.data(), data);
+        });
+    };
+    context.onSuccess = [this, parser, userHome](const QByteArray &data) {
+        parse([this, parser, userHome, data](OBSXmlReader *reader) {
+            reader->parseProjectListData(parser.data(), data);
+            QStringList list = reader->finishProjectList(parser.data());
+            parser->clear();
+            QMetaObject::invokeMethod(this, [this, userHome, list]() {
+                projectLists.insert(userHome, list);
+            }, Qt::QueuedConnection);
+        });
+    };
+    context.onNotModified = [this, userHome](const QByteArray &) {
+        xmlReader->replayProjectList(projectLists.value(userHome));
+    };
+    requestSource("", context);
+}
 
-            case OBSCore::LinkPackage: {
-                qDebug() << reqTypeStr << "LinkPackage";
-                QString project;
-                QString package;
-                if (reply->property("destprj").isValid()) {
-                    project = reply->property("destprj").toString();
-                }
-                if (reply->property("destpkg").isValid()) {
-                    package = reply->property("destpkg").toString();
-                }
-                xmlReader->parseLinkPackage(project, package, dataStr);
-                break;
-            }
+void OBSCore::getProjectMetaConfig(const QString &resource)
+{
+    if (invokeInNetworkThread([this, resource]() {
+        getProjectMetaConfig(resource);
+    })) {
+        return;
+    }
+    RequestContext context(OBSCore::PrjMetaConfig);
+    context.onSuccess = [this](const QByteArray &data) {
+        // <project>
+        parse([data](OBSXmlReader *reader) {
+            reader->parsePrjMetaConfig(data);
+        });
+    };
+    requestSource(resource, context);
+}
 
-            case OBSCore::CopyPackage: {
-                qDebug() << reqTypeStr << "CopyPackage";
-                QString project;
-                QString package;
-                if (reply->property("destprj").isValid()) {
-                    project = reply->property("destprj").toString();
-                }
-                if (reply->property("destpkg").isValid()) {
-                    package = reply->property("destpkg").toString();
-                }
-                xmlReader->parseCopyPackage(project, package, dataStr);
-                break;
-            }
+void OBSCore::getPackageMetaConfig(const QString &resource)
+{
+    if (invokeInNetworkThread([this, resource]() {
+        getPackageMetaConfig(resource);
+    })) {
+        return;
+    }
+    RequestContext context(OBSCore::PkgMetaConfig);
+    context.onSuccess = [this](const QByteArray &data) {
+        // <package>
+        parse([data](OBSXmlReader *reader) {
+            reader->parsePkgMetaConfig(data);
+        });
+    };
+    requestSource(resource, context);
+}
 
-            case OBSCore::CreateRequest: {
-                qDebug() << reqTypeStr << "CreateRequest";
-                xmlReader->parseCreateRequest(dataStr);
-                break;
-            }
+OBSRequestHandle OBSCore::getPackages(const QString &resource)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, resource, handle]() {
+        getPackages(resource, handle);
+    })) {
+        getPackages(resource, handle);
+    }
+    return handle;
+}
 
-            case OBSCore::CreateProject: {
-                qDebug() << reqTypeStr << "CreateProject";
-                QString project;
-                if (reply->property("createprj").isValid()) {
-                    project = reply->property("createprj").toString();
-                }
-                xmlReader->parseCreateProject(project, dataStr);
-                break;
-            }
+void OBSCore::getPackages(const QString &resource, const OBSRequestHandle &handle)
+{
+    QString project = resource.mid(1);
+    RequestContext context(OBSCore::PackageList);
+    context.conditional = true;
+    context.handle = handle;
+    QSharedPointer<OBSListParser> parser(new OBSListParser());
+    context.onReadyRead = [this, parser, project, handle](const QByteArray &data) {
+        // <directory>
+        parse([parser, project, data](OBSXmlReader *reader) {
+            reader->parsePackageListData(parser.data(), data, project);
+        }, handle);
+    };
+    context.onSuccess = [this, parser, resource, project, handle](const QByteArray &data) {
+        parse([this, parser, resource, project, data](OBSXmlReader *reader) {
+            reader->parsePackageListData(parser.data(), data, project);
+            QStringList list = reader->finishPackageList(parser.data(), project);
+            parser->clear();
+            QMetaObject::invokeMethod(this, [this, resource, list]() {
+                packageLists.insert(resource, list);
+            }, Qt::QueuedConnection);
+        }, handle);
+    };
+    context.onNotModified = [this, resource, project](const QByteArray &) {
+        xmlReader->replayPackageList(packageLists.value(resource), project);
+    };
+    context.onNotFound = [this](const QByteArray &data) {
+        // <status>
+        if (isAuthenticated()) {
+            parse([this, data](OBSXmlReader *reader) {
+                OBSStatus *status = reader->parseNotFoundStatus(data);
+                qDebug() << "OBSCore::getPackages() Project not found!" << status->getSummary() << status->getCode();
+                QMetaObject::invokeMethod(this, [this, status]() {
+                    emit projectNotFound(status);
+                }, Qt::QueuedConnection);
+            });
+        }
+    };
+    requestSource(resource, context);
+}
 
-            case OBSCore::CreatePackage: {
-                qDebug() << reqTypeStr << "CreatePackage";
-                QString project;
-                QString package;
-                if (reply->property("createprj").isValid()) {
-                    project = reply->property("createprj").toString();
-                }
-                if (reply->property("createpkg").isValid()) {
-                    package = reply->property("createpkg").toString();
-                }
-                xmlReader->parseCreatePackage(project, package, dataStr);
-                break;
-            }
+OBSRequestHandle OBSCore::getFiles(const QString &project, const QString &package)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, package, handle]() {
+        getFiles(project, package, handle);
+    })) {
+        getFiles(project, package, handle);
+    }
+    return handle;
+}
 
-            case OBSCore::UploadFile: {
-                qDebug() << reqTypeStr << "UploadFile";
-                QString project;
-                QString package;
-                QString file;
-                if (reply->property("uploadprj").isValid()) {
-                    project = reply->property("uploadprj").toString();
-                }
-                if (reply->property("uploadpkg").isValid()) {
-                    package = reply->property("uploadpkg").toString();
-                }
-                if (reply->property("uploadfile").isValid()) {
-                    file = reply->property("uploadfile").toString();
-                }
-                xmlReader->parseUploadFile(project, package, file, dataStr);
-                break;
-            }
+void OBSCore::getFiles(const QString &project, const QString &package, const OBSRequestHandle &handle)
+{
+    QString resource = QString("/%1/%2").arg(project, package);
+    RequestContext context(OBSCore::FileList);
+    context.handle = handle;
+    context.onSuccess = [this, project, package, handle](const QByteArray &data) {
+        // <directory>
+        parse([project, package, data](OBSXmlReader *reader) {
+            reader->parseFileList(project, package, data);
+        }, handle);
+    };
+    context.onNotFound = [this](const QByteArray &data) {
+        // <status>
+        if (isAuthenticated()) {
+            parse([this, data](OBSXmlReader *reader) {
+                OBSStatus *status = reader->parseNotFoundStatus(data);
+                qDebug() << "OBSCore::getFiles() Package not found!" << status->getSummary() << status->getCode();
+                QMetaObject::invokeMethod(this, [this, status]() {
+                    emit packageNotFound(status);
+                }, Qt::QueuedConnection);
+            });
+        }
+    };
+    requestSource(resource, context);
+}
 
-            case OBSCore::DownloadFile: {
-                qDebug() << reqTypeStr << "DownloadFile";
-                QString fileName;
-                if (reply->property("downloadfile").isValid()) {
-                    fileName = reply->property("downloadfile").toString();
-                }
-                emit fileFetched(fileName, data);
-                break;
-            }
+OBSRequestHandle OBSCore::getFileMd5List(const QString &project, const QString &package)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, package, handle]() {
+        getFileMd5List(project, package, handle);
+    })) {
+        getFileMd5List(project, package, handle);
+    }
+    return handle;
+}
 
-            case OBSCore::BuildLog: {
-                qDebug() << reqTypeStr << "BuildLog";
-                emit buildLogFetched(dataStr);
-                break;
-            }
+void OBSCore::getFileMd5List(const QString &project, const QString &package, const OBSRequestHandle &handle)
+{
+    // Like getFiles(), but the result goes to whoever asked instead of the file view
+    QString resource = QString("/%1/%2").arg(project, package);
+    RequestContext context(OBSCore::FileMd5List);
+    context.handle = handle;
+    context.onSuccess = [this, project, package, handle](const QByteArray &data) {
+        parse([this, project, package, data](OBSXmlReader *reader) {
+            QString srcmd5;
+            QHash<QString, QString> files = reader->parseFileMd5List(data, &srcmd5);
+            QMetaObject::invokeMethod(this, [this, project, package, srcmd5, files]() {
+                emit fileMd5ListFetched(project, package, srcmd5, files);
+            }, Qt::QueuedConnection);
+        }, handle);
+    };
+    context.onNotFound = [this, project, package](const QByteArray &) {
+        emit fileMd5ListFailed(project, package, tr("Package %1/%2 not found").arg(project, package));
+    };
+    context.onAccessDenied = [this, project, package](const QByteArray &) {
+        emit fileMd5ListFailed(project, package, tr("Access denied"));
+    };
+    context.onError = [this, project, package](const QByteArray &) {
+        emit fileMd5ListFailed(project, package, tr("Network error"));
+    };
+    requestSource(resource, context);
+}
 
-            case OBSCore::DeleteProject: {
-                qDebug() << reqTypeStr << "DeleteProject";
-                QString project;
-                if (reply->property("deleteprj").isValid()) {
-                    project = reply->property("deleteprj").toString();
-                }
-                xmlReader->parseDeleteProject(project, dataStr);
-                break;
-            }
+void OBSCore::getLink(const QString &project, const QString &package)
+{
+    if (invokeInNetworkThread([this, project, package]() {
+        getLink(project, package);
+    })) {
+        return;
+    }
+    QString resource = QString("/source/%1/%2/_link").arg(project, package);
+    RequestContext context(OBSCore::Link);
+    context.onSuccess = [this](const QByteArray &data) {
+        // <link>
+        parse([data](OBSXmlReader *reader) {
+            reader->parseLink(data);
+        });
+    };
+    request(resource, context);
+}
 
-            case OBSCore::DeletePackage: {
-                qDebug() << reqTypeStr << "DeletePackage";
-                QString project;
-                QString package;
-                if (reply->property("deleteprj").isValid()) {
-                    project = reply->property("deleteprj").toString();
-                }
-                if (reply->property("deletepkg").isValid()) {
-                    package = reply->property("deletepkg").toString();
-                }
-                xmlReader->parseDeletePackage(project, package, dataStr);
-                break;
-            }
+OBSRequestHandle OBSCore::getAllBuildStatus(const QString &resource)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, resource, handle]() {
+        getAllBuildStatus(resource, handle);
+    })) {
+        getAllBuildStatus(resource, handle);
+    }
+    return handle;
+}
 
-            case OBSCore::DeleteFile: {
-                qDebug() << reqTypeStr << "DeleteFile";
-                QString project;
-                QString package;
-                QString fileName;
-                if (reply->property("deleteprj").isValid()) {
-                    project = reply->property("deleteprj").toString();
-                }
-                if (reply->property("deletepkg").isValid()) {
-                    package = reply->property("deletepkg").toString();
-                }
-                if (reply->property("deletefile").isValid()) {
-                    fileName = reply->property("deletefile").toString();
-                }
-                xmlReader->parseDeleteFile(project, package, fileName, dataStr);
-                break;
-            }
+void OBSCore::getAllBuildStatus(const QString &resource, const OBSRequestHandle &handle)
+{
+    RequestContext context(OBSCore::BuildStatusList);
+    context.conditional = true;
+    context.handle = handle;
+    context.onSuccess = [this, handle](const QByteArray &data) {
+        // <resultlist>
+        parse([data](OBSXmlReader *reader) {
+            reader->parseResultList(data);
+        }, handle);
+    };
+    requestBuild(resource, context);
+}
 
-            case OBSCore::About:
-                qDebug() << reqTypeStr << "About";
-                xmlReader->parseAbout(dataStr);
-                break;
+void OBSCore::request(const QString &resource, int row)
+{
+    if (invokeInNetworkThread([this, resource, row]() {
+        request(resource, row);
+    })) {
+        return;
+    }
+    request(resource, buildStatusContext(row));
+}
 
-            case OBSCore::Person:
-                qDebug() << reqTypeStr << "Person";
-                xmlReader->parsePerson(dataStr);
-                break;
+void OBSCore::cancelRequest(const OBSRequestHandle &handle)
+{
+    if (handle.isNull()) {
+        return;
+    }
 
-            case OBSCore::UpdatePerson:
-                qDebug() << reqTypeStr << "UpdatePerson";
-                xmlReader->parseUpdatePerson(dataStr);
-                break;
+    // Marked at once, so that its replies are not parsed any more
+    OBSRequestHandle cancelledHandle(handle);
+    cancelledHandle.cancel();
 
-            case OBSCore::Distributions:
-                qDebug() << reqTypeStr << "Distributions";
-                xmlReader->parseDistributions(dataStr);
-                break;
-            }
-            return;
+    if (invokeInNetworkThread([this, handle]() {
+        cancelRequest(handle);
+    })) {
+        return;
+    }
+
+    // A shared reply is only cancelled once all of its waiters are
+    QList<QNetworkReply *> replies;
+    for (auto it = requestContexts.constBegin(); it != requestContexts.constEnd(); ++it) {
+        if (it.value().handle.isCancelled()) {
+            replies.append(it.key());
         }
-        QString dataStr = QString::fromUtf8(data);
-        xmlReader->addData(dataStr);
-        break; // end of case QNetworkReply::NoError
     }
+    for (QNetworkReply *reply : replies) {
+        qDebug() << "OBSCore::cancelRequest() Aborting" << reply->url().toString();
+        reply->abort();
+    }
+}
 
-    case QNetworkReply::ContentNotFoundError: // 404
-        if (reply->property("reqtype").isValid()) {
+QNetworkReply *OBSCore::sendPost(const QString &resource, const QByteArray &data, const QString &contentTypeHeader)
+{
+    QNetworkRequest request = createNetworkRequest(resource);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, contentTypeHeader);
+    QNetworkReply *reply = getManager()->post(request, data);
 
-            switch(reply->property("reqtype").toInt()) {
+    return reply;
+}
 
-            case OBSCore::Login:
-                qDebug() << reqTypeStr << "Login"; // <hash><status>
-                qDebug() << "OBSCore::replyFinished() OBS API not found at" << reply->url().toString();
-                emit apiNotFound(reply->url());
-                break;
+void OBSCore::postRequest(const QString &resource, const QByteArray &data, const QString &contentTypeHeader)
+{
+    if (invokeInNetworkThread([this, resource, data, contentTypeHeader]() {
+        postRequest(resource, data, contentTypeHeader);
+    })) {
+        return;
+    }
+    schedule([this, resource, data, contentTypeHeader]() {
+        return sendPost(resource, data, contentTypeHeader);
+    });
+}
 
-            case OBSCore::PackageList: // <status>
-                qDebug() << reqTypeStr << "PackageList";
-                if (isAuthenticated()) {
-                    QString dataStr = QString::fromUtf8(data);
-                    OBSStatus *status = xmlReader->parseNotFoundStatus(dataStr);
-                    qDebug() << "OBSCore::replyFinished() Project not found!" << status->getSummary() << status->getCode();
-                    emit projectNotFound(status);
-                }
-                break;
+void OBSCore::postRequest(const QString &resource, const QByteArray &data,
+                          const QString &contentTypeHeader, const RequestContext &context)
+{
+    schedule([this, resource, data, contentTypeHeader]() {
+        return sendPost(resource, data, contentTypeHeader);
+    }, context);
+}
 
-            case OBSCore::FileList: // <status>
-                qDebug() << reqTypeStr << "FileList";
-                if (isAuthenticated()) {
-                    QString dataStr = QString::fromUtf8(data);
-                    OBSStatus *status = xmlReader->parseNotFoundStatus(dataStr);
-                    qDebug() << "OBSCore::replyFinished() Package not found!" << status->getSummary() << status->getCode();
-                    emit packageNotFound(status);
-                }
-                break;
+QNetworkReply *OBSCore::sendPut(const QString &resource, const QByteArray &data)
+{
+    QNetworkRequest request = createNetworkRequest(resource);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/xml");
+    QNetworkReply *reply = getManager()->put(request, data);
 
-            case OBSCore::BuildStatus: // <status>
-                qDebug() << reqTypeStr << "BuildStatus";
-                if (isAuthenticated()) {
-                    QString dataStr = QString::fromUtf8(data);
-                    xmlReader->parseBuildStatus(dataStr);
-                }
-                break;
+    return reply;
+}
 
-            case OBSCore::CreateRequest:
-                xmlReader->parseCreateRequestStatus(data);
-                break;
+QNetworkReply *OBSCore::sendPut(const QString &resource, QIODevice *device)
+{
+    QNetworkRequest request = createNetworkRequest(resource);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    request.setHeader(QNetworkRequest::ContentLengthHeader, device->size());
+    QNetworkReply *reply = getManager()->put(request, device);
+    // QNAM reads the device until the reply has finished
+    device->setParent(reply);
 
-            case OBSCore::LinkPackage: {
-                qDebug() << reqTypeStr << "LinkPackage";
-                QString project;
-                QString package;
-                if (reply->property("destprj").isValid()) {
-                    project = reply->property("destprj").toString();
-                }
-                if (reply->property("destpkg").isValid()) {
-                    package = reply->property("destpkg").toString();
-                }
-                OBSStatus *status = new OBSStatus();
-                QString details = QString("The package %2 in project %1 does NOT exist.").arg(project, package);
-                status->setDetails(details);
-                status->setSummary("Cannot link");
-                status->setCode("error");
-                status->setProject(project);
-                status->setPackage(package);
-
-                emit cannotLinkPackage(status);
-                break;
-            }
+    return reply;
+}
 
-            case OBSCore::BuildLog: {
-                qDebug() << reqTypeStr << "BuildLog";
-                emit buildLogNotFound();
-                break;
-            }
+void OBSCore::putRequest(const QString &resource, const QByteArray &data)
+{
+    if (invokeInNetworkThread([this, resource, data]() {
+        putRequest(resource, data);
+    })) {
+        return;
+    }
+    schedule([this, resource, data]() {
+        return sendPut(resource, data);
+    });
+}
 
-            default:
-                qDebug() << "OBSCore Error 404 NOT handled for request type" << reply->property("reqtype").toInt();
-            }
-        }
-        break;
+void OBSCore::putRequest(const QString &resource, const QByteArray &data, const RequestContext &context)
+{
+    schedule([this, resource, data]() {
+        return sendPut(resource, data);
+    }, context);
+}
 
-    case QNetworkReply::ProtocolInvalidOperationError: // 400
-        if (reply->property("reqtype").isValid()) {
+QNetworkReply *OBSCore::sendDelete(const QString &resource)
+{
+    QNetworkRequest request = createNetworkRequest(resource);
+    QNetworkReply *reply = getManager()->deleteResource(request);
 
-            switch(reply->property("reqtype").toInt()) {
-            case OBSCore::CreateRequest:
-                xmlReader->parseCreateRequestStatus(data);
-                break;
-            default:
-                qDebug() << "OBSCore::replyFinished() Request failed! Error:" << reply->errorString();
-                qDebug() << data;
-                emit networkError(reply->errorString());
-                break;
-            }
+    return reply;
+}
 
+void OBSCore::deleteRequest(const QString &resource)
+{
+    if (invokeInNetworkThread([this, resource]() {
+        deleteRequest(resource);
+    })) {
+        return;
+    }
+    schedule([this, resource]() {
+        return sendDelete(resource);
+    });
+}
+
+void OBSCore::deleteRequest(const QString &resource, const RequestContext &context)
+{
+    schedule([this, resource]() {
+        return sendDelete(resource);
+    }, context);
+}
+
+void OBSCore::changeSubmitRequest(const QString &resource, const QByteArray &data)
+{
+    if (invokeInNetworkThread([this, resource, data]() {
+        changeSubmitRequest(resource, data);
+    })) {
+        return;
+    }
+    RequestContext context(OBSCore::ChangeRequestState);
+    context.onSuccess = [this](const QByteArray &data) {
+        parse([data](OBSXmlReader *reader) {
+            reader->parseRequestStatus(data);
+        });
+    };
+    postRequest(resource, data, "application/x-www-form-urlencoded", context);
+}
+
+void OBSCore::provideAuthentication(QNetworkReply *reply, QAuthenticator *ator)
+{
+    qDebug() << "OBSCore::provideAuthentication() for" << reply->request().url().toString();
+
+    // Credentials are sent with every request, so a challenge to a request
+    // which carried the current ones means that they were rejected. Answering
+    // it would loop, and probably get the account blocked :-(
+    QByteArray authorization = authorizationHeader();
+    if (authorization.isEmpty() || reply->request().rawHeader("Authorization") == authorization) {
+        qDebug() << "OBSCore::provideAuthentication() Credentials not accepted!";
+        return;
+    }
+
+    // The request was sent before the credentials changed
+    QMutexLocker locker(&mutex);
+    ator->setUser(curUsername);
+    ator->setPassword(curPassword);
+}
+
+void OBSCore::setAuthenticated(bool authenticated)
+{
+    QMutexLocker locker(&mutex);
+    this->authenticated = authenticated;
+}
+
+bool OBSCore::isAuthenticated()
+{
+    QMutexLocker locker(&mutex);
+    return authenticated;
+}
+
+void OBSCore::replyFinished(QNetworkReply *reply)
+{
+    // QNetworkReply is a sequential-access QIODevice, which means that
+    // once data is read from the object, it no longer kept by the device.
+    // It is therefore the application's responsibility to keep this data if it needs to.
+    // See http://doc.qt.nokia.com/latest/qnetworkreply.html for more info
+    if (heldReplies.contains(reply)) {
+        qDebug() << "OBSCore::replyFinished() Holding until the certificate is answered" << reply->url().toString();
+        return;
+    }
+
+    if (discardedReplies.remove(reply)) {
+        // Aborted by resetSession()
+        reply->deleteLater();
+        return;
+    }
+
+    QByteArray data = reply->readAll();
+    bool streamed = streamedBodies.contains(reply);
+    // Discarded unless committed
+    QScopedPointer<OBSDiskCacheEntry> streamedEntry(streamedBodies.take(reply));
+
+    qDebug() << "OBSCore::replyFinished()" << reply->url().toString();
+    int httpStatusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    qDebug() << "OBSCore::replyFinished() HTTP status code:" << httpStatusCode;
+//    qDebug() << "Network Reply: " << data;
+
+    if (httpStatusCode==302) {
+        setAuthenticated(true);
+        emit isAuthenticated(true);
+    } else if (httpStatusCode==401) {
+        setAuthenticated(false);
+        emit isAuthenticated(false);
+    }
+
+    bool hasContext = requestContexts.contains(reply);
+    RequestContext context = requestContexts.take(reply);
+    bool timedOut = timedOutReplies.remove(reply);
+
+    if (context.handle.isCancelled()) {
+        qDebug() << "OBSCore::replyFinished() Dropping cancelled request" << context.handle.getId();
+        releaseInFlightGet(context);
+        reply->deleteLater();
+        return;
+    }
+
+    if (reply->attribute(QNetworkRequest::HTTP2WasUsedAttribute).toBool()) {
+        http2Replies++;
+    } else {
+        http1Replies++;
+    }
+
+    if (isHttp2Failure(reply) && !http2Unavailable) {
+        qDebug() << "OBSCore::replyFinished() HTTP/2 failed, falling back to HTTP/1.1";
+        http2Unavailable = true;
+        if (hasContext && reply->operation() == QNetworkAccessManager::GetOperation &&
+                context.attempt < maxRetries && !streamed) {
+            retry(context, 0);
+            reply->deleteLater();
+            return;
         }
-        break;
+    }
 
-    case QNetworkReply::ContentAccessDenied: // 401
-        qDebug() << "OBSCore::replyFinished() Access denied!";
-        if (reply->property("reqtype").isValid()) {
-            OBSStatus *obsStatus = nullptr;
-            switch(reply->property("reqtype").toInt()) {
-
-            case OBSCore::CopyPackage: {
-                obsStatus = new OBSStatus();
-                QString project;
-                QString package;
-                if (reply->property("destprj").isValid()) {
-                    project = reply->property("destprj").toString();
-                }
-                if (reply->property("destpkg").isValid()) {
-                    package = reply->property("destpkg").toString();
-                }
-                obsStatus->setProject(project);
-                obsStatus->setPackage(package);
-                obsStatus->setCode("error");
-                obsStatus->setSummary("Cannot copy");
-                obsStatus->setDetails(tr("You don't have the appropriate permissions to<br>copy %1 to %2<br>")
-                                      .arg(obsStatus->getPackage(), obsStatus->getProject()));
-                emit cannotCopyPackage(obsStatus);
-                break;
-            }
-            case OBSCore::CreateProject: {
-                obsStatus = new OBSStatus();
-                QString project;
-                if (reply->property("createprj").isValid()) {
-                    project = reply->property("createprj").toString();
-                }
-                obsStatus->setProject(project);
-                obsStatus->setCode("error");
-                obsStatus->setSummary("Cannot create");
-                obsStatus->setDetails(tr("You don't have the appropriate permissions to create<br>%1")
-                                      .arg(obsStatus->getProject()));
-                emit cannotCreateProject(obsStatus);
-                break;
+    if (hasContext && !context.longPoll) {
+        if (isTransientError(reply, httpStatusCode, timedOut)) {
+            int serverDelay = retryAfter(reply);
+            circuitBreaker->recordFailure(serverDelay);
+
+            // Coalesced waiters keep waiting for the retry. A partially
+            // streamed reply has already been handed to its parser.
+            if (reply->operation() == QNetworkAccessManager::GetOperation &&
+                    context.attempt < maxRetries && !streamed) {
+                retry(context, retryDelay(context.attempt, serverDelay));
+                reply->deleteLater();
+                return;
             }
+        } else {
+            circuitBreaker->recordSuccess();
+        }
+    }
 
-            case OBSCore::CreatePackage: {
-                obsStatus = new OBSStatus();
-                QString project;
-                QString package;
-                if (reply->property("createprj").isValid()) {
-                    project = reply->property("createprj").toString();
-                }
-                if (reply->property("createpkg").isValid()) {
-                    package = reply->property("createpkg").toString();
-                }
-                obsStatus->setProject(project);
-                obsStatus->setPackage(package);
-                obsStatus->setCode("error");
-                obsStatus->setSummary("Cannot create");
-                obsStatus->setDetails(tr("You don't have the appropriate permissions to create<br>%1/%2")
-                                      .arg(obsStatus->getProject(), obsStatus->getPackage()));
-                emit cannotCreatePackage(obsStatus);
-                break;
-            }
+    releaseInFlightGet(context);
 
-            case OBSCore::UploadFile: {
-                obsStatus = new OBSStatus();
-                QString project;
-                QString package;
-                if (reply->property("uploadprj").isValid()) {
-                    project = reply->property("uploadprj").toString();
-                }
-                if (reply->property("uploadpkg").isValid()) {
-                    package = reply->property("uploadpkg").toString();
-                }
-                obsStatus->setProject(project);
-                obsStatus->setPackage(package);
-                obsStatus->setCode("error");
-                obsStatus->setSummary("Cannot upload file");
-                obsStatus->setDetails(tr("You don't have the appropriate permissions to upload to <br>%1/%2")
-                                      .arg(obsStatus->getProject(), obsStatus->getPackage()));
-                emit cannotUploadFile(obsStatus);
-                break;
-            }
+    switch (reply->error()) {
 
-            case OBSCore::DeleteProject: {
-                obsStatus = new OBSStatus();
-                QString project;
-                if (reply->property("deleteprj").isValid()) {
-                    project = reply->property("deleteprj").toString();
+    case QNetworkReply::NoError:
+        qDebug() << "OBSCore::replyFinished() Request succeeded! Status code:" << httpStatusCode;
+        if (hasContext) {
+            qDebug() << "OBSCore::replyFinished() RequestType" << context.type;
+            if (httpStatusCode==304) {
+                if (context.servedStale) {
+                    qDebug() << "OBSCore::replyFinished() Cached response is up to date";
+                } else if (!resourceCache.contains(context.key)) {
+                    qDebug() << "OBSCore::replyFinished() Not modified, but nothing cached for" << context.key;
+                } else if (context.onNotModified) {
+                    context.onNotModified(resourceCache.value(context.key).data);
+                } else if (!serveCachedResponse(context)) {
+                    qDebug() << "OBSCore::replyFinished() Not modified, but the cached body is gone for" << context.key;
                 }
-                obsStatus->setProject(project);
-                obsStatus->setCode("error");
-                obsStatus->setSummary("Cannot delete");
-                obsStatus->setDetails(tr("You don't have the appropriate permissions to delete<br>%1")
-                                      .arg(obsStatus->getProject()));
-                emit cannotDeleteProject(obsStatus);
                 break;
             }
-
-            case OBSCore::DeletePackage: {
-                obsStatus = new OBSStatus();
-                QString project;
-                QString package;
-                if (reply->property("deleteprj").isValid()) {
-                    project = reply->property("deleteprj").toString();
+            if (context.conditional) {
+                if (streamedEntry) {
+                    storeStreamedResponse(reply, context, streamedEntry.data(), data);
+                } else {
+                    storeResponse(reply, context, data);
                 }
-                if (reply->property("deletepkg").isValid()) {
-                    package = reply->property("deletepkg").toString();
-                }
-                obsStatus->setProject(project);
-                obsStatus->setPackage(package);
-                obsStatus->setCode("error");
-                obsStatus->setSummary("Cannot delete");
-                obsStatus->setDetails(tr("You don't have the appropriate permissions to delete<br>%1/%2")
-                                      .arg(obsStatus->getProject(), obsStatus->getPackage()));
-                emit cannotDeletePackage(obsStatus);
-                break;
             }
+            // For streamed replies, data is what hasn't been read yet
+            if (context.onSuccess) {
+                context.onSuccess(data);
+            }
+        } else {
+            parse([data](OBSXmlReader *reader) {
+                reader->addData(data);
+            });
+        }
+        break;
 
-            case OBSCore::DeleteFile: {
-                obsStatus = new OBSStatus();
-                QString project;
-                QString package;
-                QString fileName;
-                if (reply->property("deleteprj").isValid()) {
-                    project = reply->property("deleteprj").toString();
-                }
-                if (reply->property("deletepkg").isValid()) {
-                    package = reply->property("deletepkg").toString();
-                }
-                if (reply->property("deletefile").isValid()) {
-                    fileName = reply->property("deletefile").toString();
-                }
-                obsStatus->setProject(project);
-                obsStatus->setPackage(package);
-                obsStatus->setCode("error");
-                obsStatus->setSummary("Cannot delete");
-                obsStatus->setDetails(tr("You don't have the appropriate permissions to delete<br>%1/%2/%3")
-                                      .arg(obsStatus->getProject(), obsStatus->getPackage(), fileName));
-                emit cannotDeleteFile(obsStatus);
-                break;
+    case QNetworkReply::ContentNotFoundError: // 404
+        if (hasContext) {
+            if (context.onNotFound) {
+                context.onNotFound(data);
+            } else {
+                qDebug() << "OBSCore Error 404 NOT handled for request type" << context.type;
             }
+        }
+        break;
 
+    case QNetworkReply::ProtocolInvalidOperationError: // 400
+        if (hasContext) {
+            if (context.onBadRequest) {
+                context.onBadRequest(data);
+            } else {
+                qDebug() << "OBSCore::replyFinished() Request failed! Error:" << reply->errorString();
+                qDebug() << data;
+                emit networkError(reply->errorString());
             }
         }
         break;
 
+    case QNetworkReply::ContentAccessDenied: // 401
+        qDebug() << "OBSCore::replyFinished() Access denied!";
+        if (hasContext && context.onAccessDenied) {
+            context.onAccessDenied(data);
+        }
+        break;
+
     case QNetworkReply::AuthenticationRequiredError:
         qDebug() << "OBSCore::replyFinished() Credentials provided not accepted!";
+        if (hasContext && context.onError) {
+            context.onError(data);
+        }
         break;
 
     default: // Other errors
+        // A partially streamed reply can't be completed from the cache
+        if (hasContext && context.conditional && !streamed && serveCachedResponse(context)) {
+            qDebug() << "OBSCore::replyFinished() Network error, using cached response";
+        }
         qDebug() << "OBSCore::replyFinished() Request failed! Error:" << reply->errorString();
         qDebug() << data;
-        emit networkError(reply->errorString());
+        if (hasContext && context.onError) {
+            context.onError(data);
+        } else if (hasContext && priorityForType(context.type) == OBSRequestScheduler::Background) {
+            // Polling tries again later, no need to bother the user
+            qDebug() << "OBSCore::replyFinished() Background request failed, not reporting it";
+        } else {
+            emit networkError(reply->errorString());
+        }
         break;
     }
 
     reply->deleteLater();
 }
 
+bool OBSCore::isTransientError(QNetworkReply *reply, int httpStatusCode, bool timedOut)
+{
+    if (timedOut) {
+        return true;
+    }
+
+    switch (httpStatusCode) {
+    case 429: // Too Many Requests
+    case 500:
+    case 502:
+    case 503:
+    case 504:
+        return true;
+    default:
+        break;
+    }
+
+    switch (reply->error()) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int OBSCore::retryAfter(QNetworkReply *reply)
+{
+    // Retry-After: <seconds> or Retry-After: <HTTP-date>
+    QByteArray value = reply->rawHeader("Retry-After").trimmed();
+    if (value.isEmpty()) {
+        return 0;
+    }
+
+    bool ok;
+    qint64 msec = value.toLongLong(&ok) * 1000;
+    if (!ok) {
+        QDateTime date = QDateTime::fromString(QString::fromLatin1(value), Qt::RFC2822Date);
+        msec = date.isValid() ? QDateTime::currentDateTimeUtc().msecsTo(date) : 0;
+    }
+    return int(qBound(qint64(0), msec, qint64(maxRetryDelay * 5)));
+}
+
+int OBSCore::retryDelay(int attempt, int retryAfter)
+{
+    if (retryAfter > 0) {
+        return retryAfter;
+    }
+
+    // Exponential backoff with jitter, so that clients don't retry in lockstep
+    int delay = qMin(retryBaseDelay * (1 << attempt), maxRetryDelay);
+    return delay / 2 + int(QRandomGenerator::global()->bounded(delay / 2 + 1));
+}
+
+void OBSCore::retry(const RequestContext &context, int delay)
+{
+    RequestContext retryContext(context);
+    retryContext.attempt++;
+    quint32 generation = sessionGeneration;
+    qDebug() << "OBSCore::retry() Attempt" << retryContext.attempt << "of request type" << context.type
+             << "in" << delay << "ms";
+
+    QTimer::singleShot(delay, this, [this, retryContext, generation]() {
+        if (generation != sessionGeneration) {
+            return;
+        }
+        if (retryContext.handle.isCancelled()) {
+            releaseInFlightGet(retryContext);
+            return;
+        }
+        schedule(retryContext.send, retryContext);
+    });
+}
+
+void OBSCore::releaseInFlightGet(const RequestContext &context)
+{
+    // A request that was not coalesced has no entry, or one of a newer request
+    if (context.key.isEmpty() || !inFlightGets.contains(context.key) ||
+            inFlightHandles.value(context.key) != context.handle) {
+        return;
+    }
+    inFlightHandles.remove(context.key);
+    int waiters = inFlightGets.take(context.key);
+    if (waiters > 1) {
+        qDebug() << "OBSCore::releaseInFlightGet() Reply shared by" << waiters << "requests";
+    }
+}
+
+QString OBSCore::diskCacheKey(const QString &key) const
+{
+    return getUsername() + " " + key;
+}
+
+void OBSCore::storeResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &data)
+{
+    OBSCachedResponse cached;
+    cached.etag = reply->rawHeader("ETag");
+    cached.lastModified = reply->rawHeader("Last-Modified");
+    cached.data = data;
+    diskCache->write(diskCacheKey(context.key), cached);
+
+    // Results replayed by onNotModified don't need the body
+    if (context.onNotModified) {
+        cached.data.clear();
+    }
+    resourceCache.insert(context.key, cached);
+}
+
+void OBSCore::storeStreamedResponse(QNetworkReply *reply, const RequestContext &context, OBSDiskCacheEntry *entry,
+                                    const QByteArray &data)
+{
+    // The body is on disk already, only the validators are kept in memory
+    entry->append(data);
+    if (!entry->commit()) {
+        resourceCache.remove(context.key);
+        return;
+    }
+    OBSCachedResponse cached;
+    cached.etag = reply->rawHeader("ETag");
+    cached.lastModified = reply->rawHeader("Last-Modified");
+    resourceCache.insert(context.key, cached);
+}
+
+bool OBSCore::serveCachedResponse(const RequestContext &context)
+{
+    if (context.servedStale) {
+        return true;
+    }
+
+    OBSCachedResponse cached = resourceCache.value(context.key);
+    if (cached.data.isEmpty() && !diskCache->read(diskCacheKey(context.key), cached)) {
+        return false;
+    }
+    if (context.onSuccess) {
+        context.onSuccess(cached.data);
+    }
+    return true;
+}
+
 void OBSCore::getSRDiff(const QString &resource)
 {
-    QNetworkReply *reply = postRequest(resource, "", "application/x-www-form-urlencoded");
-    reply->setProperty("reqtype", OBSCore::SRDiff);
+    if (invokeInNetworkThread([this, resource]() {
+        getSRDiff(resource);
+    })) {
+        return;
+    }
+    RequestContext context(OBSCore::SRDiff);
+    context.onSuccess = [this](const QByteArray &data) {
+        emit srDiffFetched(QString::fromUtf8(data));
+    };
+    postRequest(resource, "", "application/x-www-form-urlencoded", context);
 }
 
 void OBSCore::branchPackage(const QString &project, const QString &package)
 {
+    if (invokeInNetworkThread([this, project, package]() {
+        branchPackage(project, package);
+    })) {
+        return;
+    }
     QString resource = QString("/source/%1/%2?cmd=branch").arg(project, package);
-    QNetworkReply *reply = postRequest(resource, "", "application/x-www-form-urlencoded");
-    reply->setProperty("reqtype", OBSCore::BranchPackage);
-    reply->setProperty("branchprj", project);
-    reply->setProperty("branchpkg", package);
+    RequestContext context(OBSCore::BranchPackage);
+    context.onSuccess = [this, project, package](const QByteArray &data) {
+        parse([project, package, data](OBSXmlReader *reader) {
+            reader->parseBranchPackage(project, package, data);
+        });
+    };
+    postRequest(resource, "", "application/x-www-form-urlencoded", context);
 }
 
 void OBSCore::linkPackage(const QString &srcProject, const QString &srcPackage, const QString &dstProject)
 {
+    if (invokeInNetworkThread([this, srcProject, srcPackage, dstProject]() {
+        linkPackage(srcProject, srcPackage, dstProject);
+    })) {
+        return;
+    }
     linkHelper = new OBSLinkHelper(this);
 
     connect(xmlReader, &OBSXmlReader::finishedParsingPackageMetaConfig,
@@ -931,118 +1785,961 @@ void OBSCore::linkPackage(const QString &srcProject, const QString &srcPackage,
 void OBSCore::copyPackage(const QString &originProject, const QString &originPackage,
                           const QString &destProject, const QString &destPackage, const QString &comments)
 {
+    if (invokeInNetworkThread([this, originProject, originPackage, destProject, destPackage, comments]() {
+        copyPackage(originProject, originPackage, destProject, destPackage, comments);
+    })) {
+        return;
+    }
     QString resource = QString("/source/%1/%2?cmd=copy&oproject=%3&opackage=%4&comment=%5")
             .arg(destProject, destPackage, originProject, originPackage, comments);
-    QNetworkReply *reply = postRequest(resource, "", "application/x-www-form-urlencoded");
-    reply->setProperty("reqtype", OBSCore::CopyPackage);
-    reply->setProperty("destprj", destProject);
-    reply->setProperty("destpkg", destPackage);
+    RequestContext context(OBSCore::CopyPackage);
+    context.onSuccess = [this, destProject, destPackage](const QByteArray &data) {
+        parse([destProject, destPackage, data](OBSXmlReader *reader) {
+            reader->parseCopyPackage(destProject, destPackage, data);
+        });
+    };
+    context.onAccessDenied = [this, destProject, destPackage](const QByteArray &) {
+        OBSStatus *obsStatus = new OBSStatus();
+        obsStatus->setProject(destProject);
+        obsStatus->setPackage(destPackage);
+        obsStatus->setCode("error");
+        obsStatus->setSummary("Cannot copy");
+        obsStatus->setDetails(tr("You don't have the appropriate permissions to<br>copy %1 to %2<br>")
+                              .arg(obsStatus->getPackage(), obsStatus->getProject()));
+        emit cannotCopyPackage(obsStatus);
+    };
+    postRequest(resource, "", "application/x-www-form-urlencoded", context);
 }
 
 void OBSCore::createRequest(const QByteArray &data)
 {
+    if (invokeInNetworkThread([this, data]() {
+        createRequest(data);
+    })) {
+        return;
+    }
     QString resource = QString("/request?cmd=create");
-    QNetworkReply *reply = postRequest(resource, data, "application/xml");
-    reply->setProperty("reqtype", OBSCore::CreateRequest);
+    RequestContext context(OBSCore::CreateRequest);
+    context.onSuccess = [this](const QByteArray &data) {
+        parse([data](OBSXmlReader *reader) {
+            reader->parseCreateRequest(data);
+        });
+    };
+    context.onNotFound = [this](const QByteArray &data) {
+        parse([data](OBSXmlReader *reader) {
+            reader->parseCreateRequestStatus(data);
+        });
+    };
+    context.onBadRequest = context.onNotFound;
+    postRequest(resource, data, "application/xml", context);
 }
 
 void OBSCore::createProject(const QString &project, const QByteArray &data)
 {
+    if (invokeInNetworkThread([this, project, data]() {
+        createProject(project, data);
+    })) {
+        return;
+    }
     QString resource = QString("/source/%1/_meta").arg(project);
-    QNetworkReply *reply = putRequest(resource, data);
-    reply->setProperty("reqtype", OBSCore::CreateProject);
-    reply->setProperty("createprj", project);
+    RequestContext context(OBSCore::CreateProject);
+    context.onSuccess = [this, project](const QByteArray &data) {
+        parse([project, data](OBSXmlReader *reader) {
+            reader->parseCreateProject(project, data);
+        });
+    };
+    context.onAccessDenied = [this, project](const QByteArray &) {
+        OBSStatus *obsStatus = new OBSStatus();
+        obsStatus->setProject(project);
+        obsStatus->setCode("error");
+        obsStatus->setSummary("Cannot create");
+        obsStatus->setDetails(tr("You don't have the appropriate permissions to create<br>%1")
+                              .arg(obsStatus->getProject()));
+        emit cannotCreateProject(obsStatus);
+    };
+    putRequest(resource, data, context);
 }
 
 void OBSCore::createPackage(const QString &project, const QString &package, const QByteArray &data)
 {
+    if (invokeInNetworkThread([this, project, package, data]() {
+        createPackage(project, package, data);
+    })) {
+        return;
+    }
     QString resource = QString("/source/%1/%2/_meta").arg(project, package);
-    QNetworkReply *reply = putRequest(resource, data);
-    reply->setProperty("reqtype", OBSCore::CreatePackage);
-    reply->setProperty("createprj", project);
-    reply->setProperty("createpkg", package);
+    RequestContext context(OBSCore::CreatePackage);
+    context.onSuccess = [this, project, package](const QByteArray &data) {
+        parse([project, package, data](OBSXmlReader *reader) {
+            reader->parseCreatePackage(project, package, data);
+        });
+    };
+    context.onAccessDenied = [this, project, package](const QByteArray &) {
+        OBSStatus *obsStatus = new OBSStatus();
+        obsStatus->setProject(project);
+        obsStatus->setPackage(package);
+        obsStatus->setCode("error");
+        obsStatus->setSummary("Cannot create");
+        obsStatus->setDetails(tr("You don't have the appropriate permissions to create<br>%1/%2")
+                              .arg(obsStatus->getProject(), obsStatus->getPackage()));
+        emit cannotCreatePackage(obsStatus);
+    };
+    putRequest(resource, data, context);
 }
 
 void OBSCore::uploadFile(const QString &project, const QString &package, const QString &fileName, const QByteArray &data)
 {
+    if (invokeInNetworkThread([this, project, package, fileName, data]() {
+        uploadFile(project, package, fileName, data);
+    })) {
+        return;
+    }
     QString resource = QString("/source/%1/%2/%3").arg(project, package, fileName);
-    QNetworkReply *reply = putRequest(resource, data);
-    reply->setProperty("reqtype", OBSCore::UploadFile);
-    reply->setProperty("uploadprj", project);
-    reply->setProperty("uploadpkg", package);
-    reply->setProperty("uploadfile", fileName);
+    RequestContext context(OBSCore::UploadFile);
+    context.onSuccess = [this, project, package, fileName](const QByteArray &data) {
+        parse([project, package, fileName, data](OBSXmlReader *reader) {
+            reader->parseUploadFile(project, package, fileName, data);
+        });
+    };
+    context.onAccessDenied = [this, project, package](const QByteArray &) {
+        OBSStatus *obsStatus = new OBSStatus();
+        obsStatus->setProject(project);
+        obsStatus->setPackage(package);
+        obsStatus->setCode("error");
+        obsStatus->setSummary("Cannot upload file");
+        obsStatus->setDetails(tr("You don't have the appropriate permissions to upload to <br>%1/%2")
+                              .arg(obsStatus->getProject(), obsStatus->getPackage()));
+        emit cannotUploadFile(obsStatus);
+    };
+    putRequest(resource, data, context);
+}
+
+OBSRequestHandle OBSCore::uploadFile(const QString &project, const QString &package, const QString &fileName,
+                                     const QString &path)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, package, fileName, path, handle]() {
+        uploadFile(project, package, fileName, path, handle);
+    })) {
+        uploadFile(project, package, fileName, path, handle);
+    }
+    return handle;
 }
 
-void OBSCore::downloadFile(const QString &project, const QString &package, const QString &fileName)
+void OBSCore::uploadFile(const QString &project, const QString &package, const QString &fileName,
+                         const QString &path, const OBSRequestHandle &handle)
 {
     QString resource = QString("/source/%1/%2/%3").arg(project, package, fileName);
-    QNetworkReply *reply = request(resource);
-    reply->setProperty("reqtype", OBSCore::DownloadFile);
-    reply->setProperty("downloadprj", project);
-    reply->setProperty("downloadpkg", package);
-    reply->setProperty("downloadfile", fileName);
+    RequestContext context(OBSCore::UploadFile);
+    context.handle = handle;
+    context.onProgress = [this, path](qint64 bytesSent, qint64 bytesTotal) {
+        emit fileUploadProgress(path, bytesSent, bytesTotal);
+    };
+    context.onSuccess = [this, project, package, fileName, path](const QByteArray &data) {
+        emit fileUploadFinished(path);
+        parse([project, package, fileName, data](OBSXmlReader *reader) {
+            reader->parseUploadFile(project, package, fileName, data);
+        });
+    };
+    context.onAccessDenied = [this, project, package, path](const QByteArray &) {
+        emit fileUploadFinished(path);
+        OBSStatus *obsStatus = new OBSStatus();
+        obsStatus->setProject(project);
+        obsStatus->setPackage(package);
+        obsStatus->setCode("error");
+        obsStatus->setSummary("Cannot upload file");
+        obsStatus->setDetails(tr("You don't have the appropriate permissions to upload to <br>%1/%2")
+                              .arg(obsStatus->getProject(), obsStatus->getPackage()));
+        emit cannotUploadFile(obsStatus);
+    };
+    context.onError = [this, path](const QByteArray &) {
+        emit fileUploadFinished(path);
+        emit networkError(tr("Cannot upload %1").arg(QFileInfo(path).fileName()));
+    };
+
+    // The file is opened when the request is sent, not while it's queued
+    schedule([this, resource, project, package, path]() -> QNetworkReply * {
+        QFile *file = new QFile(path);
+        if (!file->open(QIODevice::ReadOnly)) {
+            qDebug() << "OBSCore::uploadFile() Cannot open" << path << file->errorString();
+            OBSStatus *obsStatus = new OBSStatus();
+            obsStatus->setProject(project);
+            obsStatus->setPackage(package);
+            obsStatus->setCode("error");
+            obsStatus->setSummary("Cannot upload file");
+            obsStatus->setDetails(file->errorString());
+            delete file;
+            emit fileUploadFinished(path);
+            emit cannotUploadFile(obsStatus);
+            return nullptr;
+        }
+        return sendPut(resource, file);
+    }, context);
+}
+
+OBSRequestHandle OBSCore::commitFiles(const QString &project, const QString &package, const QStringList &paths,
+                                      const QString &comment)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, package, paths, comment, handle]() {
+        commitFiles(project, package, paths, comment, handle);
+    })) {
+        commitFiles(project, package, paths, comment, handle);
+    }
+    return handle;
+}
+
+void OBSCore::commitFiles(const QString &project, const QString &package, const QStringList &paths,
+                          const QString &comment, const OBSRequestHandle &handle)
+{
+    CommitStatePtr state(new CommitState());
+    state->project = project;
+    state->package = package;
+    state->comment = comment;
+    state->handle = handle;
+    for (const QString &path : paths) {
+        state->localFiles.insert(QFileInfo(path).fileName(), path);
+    }
+    state->pendingHashes = state->localFiles.size();
+    qDebug() << "OBSCore::commitFiles()" << project << package << state->localFiles.keys();
+    emit commitProgress(project, package, tr("Hashing %1 files...").arg(state->pendingHashes));
+
+    for (auto it = state->localFiles.constBegin(); it != state->localFiles.constEnd(); ++it) {
+        QString name = it.key();
+        QThreadPool::globalInstance()->start(new OBSMd5Task(it.value(), [this, state, name](const QString &md5,
+                                                                                            const QString &errorString) {
+            QMetaObject::invokeMethod(this, [this, state, name, md5, errorString]() {
+                if (state->failed) {
+                    return;
+                }
+                if (!errorString.isEmpty()) {
+                    failCommit(state, QString("%1: %2").arg(name, errorString));
+                    return;
+                }
+                state->localMd5s.insert(name, md5);
+                if (--state->pendingHashes == 0 && state->listed) {
+                    sendCommitFileList(state);
+                }
+            }, Qt::QueuedConnection);
+        }));
+    }
+
+    // The files that aren't committed are kept as they are on the server
+    QString resource = QString("/source/%1/%2").arg(project, package);
+    RequestContext context(OBSCore::CommitFileList);
+    context.handle = handle;
+    context.tag = QString::number(handle.getId()); // its handlers belong to this commit
+    context.onSuccess = [this, state](const QByteArray &data) {
+        parse([this, state, data](OBSXmlReader *reader) {
+            QHash<QString, QString> remoteMd5s = reader->parseFileMd5List(data);
+            QMetaObject::invokeMethod(this, [this, state, remoteMd5s]() {
+                state->remoteMd5s = remoteMd5s;
+                state->listed = true;
+                if (state->pendingHashes == 0) {
+                    sendCommitFileList(state);
+                }
+            }, Qt::QueuedConnection);
+        }, state->handle);
+    };
+    context.onNotFound = [this, state](const QByteArray &) {
+        failCommit(state, tr("Package %1/%2 not found").arg(state->project, state->package));
+    };
+    context.onAccessDenied = [this, state](const QByteArray &) {
+        failCommit(state, tr("Access denied"));
+    };
+    context.onError = [this, state](const QByteArray &data) {
+        failCommit(state, data, tr("Network error"));
+    };
+    request(resource, context);
+}
+
+void OBSCore::sendCommitFileList(CommitStatePtr state)
+{
+    if (state->failed || state->handle.isCancelled()) {
+        return;
+    }
+
+    QHash<QString, QString> files = state->remoteMd5s;
+    bool changed = false;
+    for (auto it = state->localMd5s.constBegin(); it != state->localMd5s.constEnd(); ++it) {
+        changed |= (files.value(it.key()) != it.value());
+        files.insert(it.key(), it.value());
+    }
+    // Not an error, the server has these files already
+    if (!changed) {
+        qDebug() << "OBSCore::sendCommitFileList() Nothing to commit" << state->project << state->package;
+        emit nothingToCommit(state->project, state->package);
+        return;
+    }
+
+    qDebug() << "OBSCore::sendCommitFileList()" << state->project << state->package << "round" << state->rounds;
+    emit commitProgress(state->project, state->package, tr("Committing..."));
+    state->committedMd5s = files;
+    OBSXmlWriter xmlWriter;
+    QByteArray data = xmlWriter.createFileList(files);
+    QString resource = QString("/source/%1/%2?cmd=commitfilelist&user=%3&comment=%4")
+            .arg(state->project, state->package,
+                 QString::fromLatin1(QUrl::toPercentEncoding(getUsername())),
+                 QString::fromLatin1(QUrl::toPercentEncoding(state->comment)));
+
+    RequestContext context(OBSCore::CommitFileList);
+    context.handle = state->handle;
+    context.onSuccess = [this, state](const QByteArray &data) {
+        parse([this, state, data](OBSXmlReader *reader) {
+            QStringList missingFiles = reader->parseMissingFiles(data);
+            if (missingFiles.isEmpty()) {
+                reader->parseCommitFileList(state->project, state->package, data);
+                QString srcmd5 = reader->parseSrcmd5(data);
+                QMetaObject::invokeMethod(this, [this, state, srcmd5]() {
+                    emit filesCommitted(state->project, state->package, srcmd5, state->committedMd5s);
+                }, Qt::QueuedConnection);
+                return;
+            }
+            QMetaObject::invokeMethod(this, [this, state, missingFiles]() {
+                uploadMissingFiles(state, missingFiles);
+            }, Qt::QueuedConnection);
+        }, state->handle);
+    };
+    context.onBadRequest = [this, state](const QByteArray &data) {
+        failCommit(state, data, tr("The file list was rejected"));
+    };
+    context.onAccessDenied = [this, state](const QByteArray &) {
+        failCommit(state, tr("Access denied"));
+    };
+    context.onError = [this, state](const QByteArray &data) {
+        failCommit(state, data, tr("Network error"));
+    };
+    postRequest(resource, data, "application/xml", context);
+}
+
+void OBSCore::uploadMissingFiles(CommitStatePtr state, const QStringList &missingFiles)
+{
+    if (state->failed || state->handle.isCancelled()) {
+        return;
+    }
+
+    // Everything has been uploaded already, don't loop
+    if (++state->rounds > 1) {
+        failCommit(state, tr("The server is still missing %1").arg(missingFiles.join(", ")));
+        return;
+    }
+
+    qDebug() << "OBSCore::uploadMissingFiles()" << missingFiles;
+    emit commitProgress(state->project, state->package, tr("Uploading %1 files...").arg(missingFiles.size()));
+    state->pendingUploads = missingFiles.size();
+
+    for (const QString &name : missingFiles) {
+        QString path = state->localFiles.value(name);
+        if (path.isEmpty()) {
+            failCommit(state, tr("The server is missing %1, which isn't a local file").arg(name));
+            return;
+        }
+
+        QString resource = QString("/source/%1/%2/%3?rev=repository").arg(state->project, state->package, name);
+        RequestContext context(OBSCore::UploadFile);
+        context.handle = state->handle;
+        context.onSuccess = [this, state](const QByteArray &) {
+            if (--state->pendingUploads == 0) {
+                sendCommitFileList(state);
+            }
+        };
+        context.onAccessDenied = [this, state](const QByteArray &) {
+            failCommit(state, tr("Access denied"));
+        };
+        context.onError = [this, state, name](const QByteArray &data) {
+            failCommit(state, data, tr("Cannot upload %1").arg(name));
+        };
+        schedule([this, state, resource, path]() -> QNetworkReply * {
+            QFile *file = new QFile(path);
+            if (!file->open(QIODevice::ReadOnly)) {
+                failCommit(state, QString("%1: %2").arg(path, file->errorString()));
+                delete file;
+                return nullptr;
+            }
+            return sendPut(resource, file);
+        }, context);
+    }
+}
+
+void OBSCore::failCommit(CommitStatePtr state, const QString &errorString)
+{
+    if (state->failed) {
+        return;
+    }
+    qDebug() << "OBSCore::failCommit()" << state->project << state->package << errorString;
+    state->failed = true;
+    emit commitFailed(state->project, state->package, errorString);
+
+    // Stop the uploads still running, but not from within a reply handler
+    OBSRequestHandle handle = state->handle;
+    QMetaObject::invokeMethod(this, [this, handle]() {
+        cancelRequest(handle);
+    }, Qt::QueuedConnection);
+}
+
+void OBSCore::failCommit(CommitStatePtr state, const QByteArray &data, const QString &errorString)
+{
+    // The server explains most errors in a <status>
+    parse([this, state, data, errorString](OBSXmlReader *reader) {
+        OBSStatus *status = reader->parseNotFoundStatus(data);
+        QString summary = status->getSummary();
+        delete status;
+        QMetaObject::invokeMethod(this, [this, state, summary, errorString]() {
+            failCommit(state, summary.isEmpty() ? errorString : summary);
+        }, Qt::QueuedConnection);
+    });
+}
+
+OBSRequestHandle OBSCore::downloadFilePart(const QString &project, const QString &package, const QString &fileName,
+                                           const QString &path, qint64 offset)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, package, fileName, path, offset, handle]() {
+        downloadFilePart(project, package, fileName, path, offset, handle);
+    })) {
+        downloadFilePart(project, package, fileName, path, offset, handle);
+    }
+    return handle;
+}
+
+void OBSCore::downloadFilePart(const QString &project, const QString &package, const QString &fileName,
+                               const QString &path, qint64 offset, const OBSRequestHandle &handle)
+{
+    // Unlike downloadFile(), the body is appended to path, whose size must be
+    // offset, and the rest is requested with a Range header. It's up to the
+    // caller to check and rename the file once it's complete.
+    QSharedPointer<QFile> file(new QFile(path));
+    QIODevice::OpenMode mode = offset > 0 ? QIODevice::WriteOnly | QIODevice::Append
+                                          : QIODevice::WriteOnly | QIODevice::Truncate;
+    if (!file->open(mode)) {
+        qDebug() << "OBSCore::downloadFilePart() Cannot open" << path << file->errorString();
+        emit fileDownloadFailed(path, file->errorString());
+        return;
+    }
+
+    // Where the reply body starts in the file, and its status code
+    QSharedPointer<qint64> start(new qint64(offset));
+    QSharedPointer<int> statusCode(new int(0));
+
+    QString resource = QString("/source/%1/%2/%3").arg(project, package, fileName);
+    RequestContext context(OBSCore::DownloadFile);
+    context.handle = handle;
+    context.tag = QString::number(handle.getId()); // written to a file of its own
+    if (offset > 0) {
+        context.headers.insert("Range", QString("bytes=%1-").arg(offset).toLatin1());
+    }
+    context.onMetaData = [file, start, statusCode](QNetworkReply *reply) {
+        *statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (*statusCode == 200 && *start > 0) {
+            // The server ignored the Range header and sends the whole file
+            qDebug() << "OBSCore::downloadFilePart() Range not supported, restarting" << file->fileName();
+            file->resize(0);
+            file->seek(0);
+            *start = 0;
+        }
+    };
+    context.onReadyRead = [this, file, path, handle](const QByteArray &data) {
+        if (handle.isCancelled()) {
+            return;
+        }
+        if (file->write(data) == -1) {
+            qDebug() << "OBSCore::downloadFilePart() Cannot write" << path << file->errorString();
+            emit fileDownloadFailed(path, file->errorString());
+            QMetaObject::invokeMethod(this, [this, handle]() {
+                cancelRequest(handle);
+            }, Qt::QueuedConnection);
+        }
+    };
+    context.onProgress = [this, path, start](qint64 bytesReceived, qint64 bytesTotal) {
+        emit fileDownloadProgress(path, *start + bytesReceived, bytesTotal > 0 ? *start + bytesTotal : -1);
+    };
+    context.onSuccess = [this, file, path](const QByteArray &data) {
+        if (file->write(data) == -1 || !file->flush()) {
+            emit fileDownloadFailed(path, file->errorString());
+            return;
+        }
+        file->close();
+        emit fileDownloaded(path);
+    };
+    context.onNotFound = [this, path, fileName](const QByteArray &) {
+        emit fileDownloadFailed(path, tr("File %1 not found").arg(fileName));
+    };
+    context.onAccessDenied = [this, path](const QByteArray &) {
+        emit fileDownloadFailed(path, tr("Access denied"));
+    };
+    context.onError = [this, file, path, statusCode](const QByteArray &) {
+        file->close();
+        if (*statusCode == 416) {
+            // Range Not Satisfiable: there was nothing left to download
+            emit fileDownloaded(path);
+        } else if (*statusCode >= 400 && *statusCode < 500) {
+            emit fileDownloadFailed(path, tr("HTTP error %1").arg(*statusCode));
+        } else {
+            // Connection lost or server error, what has been written is kept
+            emit fileDownloadInterrupted(path);
+        }
+    };
+    request(resource, context);
+}
+
+OBSRequestHandle OBSCore::downloadFile(const QString &project, const QString &package, const QString &fileName,
+                                       const QString &path)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, package, fileName, path, handle]() {
+        downloadFile(project, package, fileName, path, handle);
+    })) {
+        downloadFile(project, package, fileName, path, handle);
+    }
+    return handle;
+}
+
+void OBSCore::downloadFile(const QString &project, const QString &package, const QString &fileName,
+                           const QString &path, const OBSRequestHandle &handle)
+{
+    // The body goes straight to a temporary file, which replaces path on
+    // success. It's discarded if the download fails or is cancelled.
+    QSharedPointer<QSaveFile> file(new QSaveFile(path));
+
+    QString resource = QString("/source/%1/%2/%3").arg(project, package, fileName);
+    RequestContext context(OBSCore::DownloadFile);
+    context.handle = handle;
+    context.tag = QString::number(handle.getId()); // written to a file of its own
+    // The file is opened when the reply arrives, not while it's queued
+    context.onMetaData = [this, file, path, handle](QNetworkReply *reply) {
+        if (file->isOpen() || reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
+            return;
+        }
+        if (!file->open(QIODevice::WriteOnly)) {
+            qDebug() << "OBSCore::downloadFile() Cannot open" << path << file->errorString();
+            emit fileDownloadFailed(path, file->errorString());
+            // Not from within the reply's metaDataChanged()
+            QMetaObject::invokeMethod(this, [this, handle]() {
+                cancelRequest(handle);
+            }, Qt::QueuedConnection);
+        }
+    };
+    context.onReadyRead = [this, file, path, handle](const QByteArray &data) {
+        // Not open if it couldn't be, which has been reported
+        if (handle.isCancelled() || !file->isOpen()) {
+            return;
+        }
+        if (file->write(data) == -1) {
+            qDebug() << "OBSCore::downloadFile() Cannot write" << path << file->errorString();
+            emit fileDownloadFailed(path, file->errorString());
+            // Not from within the reply's readyRead()
+            QMetaObject::invokeMethod(this, [this, handle]() {
+                cancelRequest(handle);
+            }, Qt::QueuedConnection);
+        }
+    };
+    context.onProgress = [this, path](qint64 bytesReceived, qint64 bytesTotal) {
+        emit fileDownloadProgress(path, bytesReceived, bytesTotal);
+    };
+    context.onSuccess = [this, file, path](const QByteArray &data) {
+        if (!file->isOpen()) {
+            return;
+        }
+        // What's left after the last readyRead()
+        if (file->write(data) == -1 || !file->commit()) {
+            emit fileDownloadFailed(path, file->errorString());
+            return;
+        }
+        qDebug() << "OBSCore::downloadFile() Saved" << path;
+        emit fileDownloaded(path);
+    };
+    context.onNotFound = [this, path, fileName](const QByteArray &) {
+        emit fileDownloadFailed(path, tr("File %1 not found").arg(fileName));
+    };
+    context.onAccessDenied = [this, path](const QByteArray &) {
+        emit fileDownloadFailed(path, tr("Access denied"));
+    };
+    context.onError = [this, path](const QByteArray &) {
+        emit fileDownloadFailed(path, tr("Network error"));
+    };
+    request(resource, context);
+}
+
+OBSRequestHandle OBSCore::downloadPackage(const QString &project, const QString &package, const QString &directory)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, package, directory, handle]() {
+        downloadPackage(project, package, directory, handle);
+    })) {
+        downloadPackage(project, package, directory, handle);
+    }
+    return handle;
+}
+
+void OBSCore::downloadPackage(const QString &project, const QString &package, const QString &directory,
+                              const OBSRequestHandle &handle)
+{
+    QString resource = QString("/source/%1/%2?view=cpio").arg(project, package);
+    downloadArchive(resource, OBSCore::DownloadPackage, directory, tr("Package %1 not found").arg(package), handle);
+}
+
+OBSRequestHandle OBSCore::getFileContents(const QString &project, const QString &package, const QString &fileName,
+                                          const QString &md5)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, package, fileName, md5, handle]() {
+        getFileContents(project, package, fileName, md5, handle);
+    })) {
+        getFileContents(project, package, fileName, md5, handle);
+    }
+    return handle;
+}
+
+void OBSCore::getFileContents(const QString &project, const QString &package, const QString &fileName,
+                              const QString &md5, const OBSRequestHandle &handle)
+{
+    // The same md5 means the same contents, whichever package they're from
+    QByteArray data;
+    if (blobStore->read(md5, data)) {
+        qDebug() << "OBSCore::getFileContents() Served from the blob store" << project << package << fileName;
+        emit fileContentsFetched(project, package, fileName, data);
+        return;
+    }
+
+    QString resource = QString("/source/%1/%2/%3").arg(project, package, fileName);
+    RequestContext context(OBSCore::FileContents);
+    context.handle = handle;
+    context.onSuccess = [this, project, package, fileName, md5](const QByteArray &data) {
+        if (!md5.isEmpty()) {
+            if (QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex() == md5.toLatin1()) {
+                blobStore->insert(md5, data);
+            } else {
+                qDebug() << "OBSCore::getFileContents() Checksum mismatch, not stored" << fileName;
+            }
+        }
+        emit fileContentsFetched(project, package, fileName, data);
+    };
+    context.onNotFound = [this, project, package, fileName](const QByteArray &) {
+        emit fileContentsFailed(project, package, fileName, tr("File %1 not found").arg(fileName));
+    };
+    context.onAccessDenied = [this, project, package, fileName](const QByteArray &) {
+        emit fileContentsFailed(project, package, fileName, tr("Access denied"));
+    };
+    context.onError = [this, project, package, fileName](const QByteArray &) {
+        emit fileContentsFailed(project, package, fileName, tr("Network error"));
+    };
+    request(resource, context);
+}
+
+OBSRequestHandle OBSCore::getBinaryList(const QString &project, const QString &repository, const QString &arch,
+                                        const QString &package)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, repository, arch, package, handle]() {
+        getBinaryList(project, repository, arch, package, handle);
+    })) {
+        getBinaryList(project, repository, arch, package, handle);
+    }
+    return handle;
+}
+
+void OBSCore::getBinaryList(const QString &project, const QString &repository, const QString &arch,
+                            const QString &package, const OBSRequestHandle &handle)
+{
+    QString resource = QString("%1/%2/%3/%4").arg(project, repository, arch, package);
+    RequestContext context(OBSCore::BinaryList);
+    context.handle = handle;
+    context.onSuccess = [this, project, repository, arch, package, handle](const QByteArray &data) {
+        // <binarylist>
+        parse([project, repository, arch, package, data](OBSXmlReader *reader) {
+            reader->parseBinaryList(project, repository, arch, package, data);
+        }, handle);
+    };
+    requestBuild(resource, context);
+}
+
+OBSRequestHandle OBSCore::downloadBinaries(const QString &project, const QString &repository, const QString &arch,
+                                           const QString &package, const QStringList &binaries,
+                                           const QString &directory)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, repository, arch, package, binaries, directory, handle]() {
+        downloadBinaries(project, repository, arch, package, binaries, directory, handle);
+    })) {
+        downloadBinaries(project, repository, arch, package, binaries, directory, handle);
+    }
+    return handle;
+}
+
+void OBSCore::downloadBinaries(const QString &project, const QString &repository, const QString &arch,
+                               const QString &package, const QStringList &binaries, const QString &directory,
+                               const OBSRequestHandle &handle)
+{
+    // Without any binary the server sends all of them
+    QString resource = QString("/build/%1/%2/%3/%4?view=cpio").arg(project, repository, arch, package);
+    for (const QString &binary : binaries) {
+        resource += "&binary=" + QString::fromLatin1(QUrl::toPercentEncoding(binary));
+    }
+    downloadArchive(resource, OBSCore::DownloadBinaries, directory, tr("Binaries not found"), handle);
+}
+
+void OBSCore::downloadArchive(const QString &resource, RequestType type, const QString &directory,
+                              const QString &notFoundError, const OBSRequestHandle &handle)
+{
+    // The files come in a single cpio archive, which is extracted to
+    // directory as it arrives
+    if (!QDir().mkpath(directory)) {
+        qDebug() << "OBSCore::downloadArchive() Cannot create" << directory;
+        emit archiveDownloadFailed(directory, tr("Cannot create directory %1").arg(directory));
+        return;
+    }
+    QSharedPointer<OBSCpioExtractor> extractor(new OBSCpioExtractor(directory));
+
+    RequestContext context(type);
+    context.handle = handle;
+    context.tag = QString::number(handle.getId()); // extracted to a directory of its own
+    context.onReadyRead = [this, extractor, directory, handle](const QByteArray &data) {
+        if (handle.isCancelled() || extractor->hasError()) {
+            return;
+        }
+        if (!extractor->addData(data)) {
+            emit archiveDownloadFailed(directory, extractor->errorString());
+            // Not from within the reply's readyRead()
+            QMetaObject::invokeMethod(this, [this, handle]() {
+                cancelRequest(handle);
+            }, Qt::QueuedConnection);
+        }
+    };
+    context.onProgress = [this, directory](qint64 bytesReceived, qint64 bytesTotal) {
+        emit archiveDownloadProgress(directory, bytesReceived, bytesTotal);
+    };
+    context.onSuccess = [this, extractor, directory](const QByteArray &data) {
+        // What's left after the last readyRead()
+        if (!extractor->addData(data)) {
+            emit archiveDownloadFailed(directory, extractor->errorString());
+            return;
+        }
+        if (!extractor->isFinished()) {
+            emit archiveDownloadFailed(directory, tr("The archive is incomplete"));
+            return;
+        }
+        qDebug() << "OBSCore::downloadArchive() Extracted" << extractor->getFiles().size() << "files to" << directory;
+        emit archiveDownloaded(directory, extractor->getFiles());
+    };
+    context.onNotFound = [this, directory, notFoundError](const QByteArray &) {
+        emit archiveDownloadFailed(directory, notFoundError);
+    };
+    context.onAccessDenied = [this, directory](const QByteArray &) {
+        emit archiveDownloadFailed(directory, tr("Access denied"));
+    };
+    context.onError = [this, directory](const QByteArray &) {
+        emit archiveDownloadFailed(directory, tr("Network error"));
+    };
+    request(resource, context);
 }
 
 void OBSCore::getBuildLog(const QString &project, const QString &repository, const QString &arch, const QString &package)
 {
+    if (invokeInNetworkThread([this, project, repository, arch, package]() {
+        getBuildLog(project, repository, arch, package);
+    })) {
+        return;
+    }
     QString resource = QString("/build/%1/%2/%3/%4/_log").arg(project, repository, arch, package);
-    QNetworkReply *reply = request(resource);
-    reply->setProperty("reqtype", OBSCore::BuildLog);
+    RequestContext context(OBSCore::BuildLog);
+    context.onSuccess = [this](const QByteArray &data) {
+        emit buildLogFetched(QString::fromUtf8(data));
+    };
+    context.onNotFound = [this](const QByteArray &) {
+        emit buildLogNotFound();
+    };
+    request(resource, context);
 }
 
 void OBSCore::deleteProject(const QString &project)
 {
+    if (invokeInNetworkThread([this, project]() {
+        deleteProject(project);
+    })) {
+        return;
+    }
     QString resource = QString("/source/%1").arg(project);
-    QNetworkReply *reply = deleteRequest(resource);
-    reply->setProperty("reqtype", OBSCore::DeleteProject);
-    reply->setProperty("deleteprj", project);
+    RequestContext context(OBSCore::DeleteProject);
+    context.onSuccess = [this, project](const QByteArray &data) {
+        parse([project, data](OBSXmlReader *reader) {
+            reader->parseDeleteProject(project, data);
+        });
+    };
+    context.onAccessDenied = [this, project](const QByteArray &) {
+        OBSStatus *obsStatus = new OBSStatus();
+        obsStatus->setProject(project);
+        obsStatus->setCode("error");
+        obsStatus->setSummary("Cannot delete");
+        obsStatus->setDetails(tr("You don't have the appropriate permissions to delete<br>%1")
+                              .arg(obsStatus->getProject()));
+        emit cannotDeleteProject(obsStatus);
+    };
+    deleteRequest(resource, context);
 }
 
 void OBSCore::deletePackage(const QString &project, const QString &package)
 {
+    if (invokeInNetworkThread([this, project, package]() {
+        deletePackage(project, package);
+    })) {
+        return;
+    }
     QString resource = QString("/source/%1/%2").arg(project, package);
-    QNetworkReply *reply = deleteRequest(resource);
-    reply->setProperty("reqtype", OBSCore::DeletePackage);
-    reply->setProperty("deleteprj", project);
-    reply->setProperty("deletepkg", package);
+    RequestContext context(OBSCore::DeletePackage);
+    context.onSuccess = [this, project, package](const QByteArray &data) {
+        parse([project, package, data](OBSXmlReader *reader) {
+            reader->parseDeletePackage(project, package, data);
+        });
+    };
+    context.onAccessDenied = [this, project, package](const QByteArray &) {
+        OBSStatus *obsStatus = new OBSStatus();
+        obsStatus->setProject(project);
+        obsStatus->setPackage(package);
+        obsStatus->setCode("error");
+        obsStatus->setSummary("Cannot delete");
+        obsStatus->setDetails(tr("You don't have the appropriate permissions to delete<br>%1/%2")
+                              .arg(obsStatus->getProject(), obsStatus->getPackage()));
+        emit cannotDeletePackage(obsStatus);
+    };
+    deleteRequest(resource, context);
 }
 
 void OBSCore::deleteFile(const QString &project, const QString &package, const QString &fileName)
 {
+    if (invokeInNetworkThread([this, project, package, fileName]() {
+        deleteFile(project, package, fileName);
+    })) {
+        return;
+    }
     QString resource = QString("/source/%1/%2/%3").arg(project, package, fileName);
-    QNetworkReply *reply = deleteRequest(resource);
-    reply->setProperty("reqtype", OBSCore::DeleteFile);
-    reply->setProperty("deleteprj", project);
-    reply->setProperty("deletepkg", package);
-    reply->setProperty("deletefile", fileName);
+    RequestContext context(OBSCore::DeleteFile);
+    context.onSuccess = [this, project, package, fileName](const QByteArray &data) {
+        parse([project, package, fileName, data](OBSXmlReader *reader) {
+            reader->parseDeleteFile(project, package, fileName, data);
+        });
+    };
+    context.onAccessDenied = [this, project, package, fileName](const QByteArray &) {
+        OBSStatus *obsStatus = new OBSStatus();
+        obsStatus->setProject(project);
+        obsStatus->setPackage(package);
+        obsStatus->setCode("error");
+        obsStatus->setSummary("Cannot delete");
+        obsStatus->setDetails(tr("You don't have the appropriate permissions to delete<br>%1/%2/%3")
+                              .arg(obsStatus->getProject(), obsStatus->getPackage(), fileName));
+        emit cannotDeleteFile(obsStatus);
+    };
+    deleteRequest(resource, context);
 }
 
 void OBSCore::about()
 {
+    if (invokeInNetworkThread([this]() {
+        about();
+    })) {
+        return;
+    }
     QString resource = "/about";
-    QNetworkReply *reply = request(resource);
-    reply->setProperty("reqtype", OBSCore::About);
+    RequestContext context(OBSCore::About);
+    context.onSuccess = [this](const QByteArray &data) {
+        parse([data](OBSXmlReader *reader) {
+            reader->parseAbout(data);
+        });
+    };
+    request(resource, context);
 }
 
 void OBSCore::getPerson()
 {
-    QString resource = "/person/" + curUsername;
-    QNetworkReply *reply = request(resource);
-    reply->setProperty("reqtype", OBSCore::Person);
+    if (invokeInNetworkThread([this]() {
+        getPerson();
+    })) {
+        return;
+    }
+    QString resource = "/person/" + getUsername();
+    RequestContext context(OBSCore::Person);
+    context.onSuccess = [this](const QByteArray &data) {
+        parse([data](OBSXmlReader *reader) {
+            reader->parsePerson(data);
+        });
+    };
+    request(resource, context);
 }
 
 void OBSCore::updatePerson(const QByteArray &data)
 {
-    QString resource = "/person/" + curUsername;
-    QNetworkReply *reply = putRequest(resource, data);
-    reply->setProperty("reqtype", OBSCore::UpdatePerson);
+    if (invokeInNetworkThread([this, data]() {
+        updatePerson(data);
+    })) {
+        return;
+    }
+    QString resource = "/person/" + getUsername();
+    RequestContext context(OBSCore::UpdatePerson);
+    context.onSuccess = [this](const QByteArray &data) {
+        parse([data](OBSXmlReader *reader) {
+            reader->parseUpdatePerson(data);
+        });
+    };
+    putRequest(resource, data, context);
 }
 
 void OBSCore::getDistributions()
 {
+    if (invokeInNetworkThread([this]() {
+        getDistributions();
+    })) {
+        return;
+    }
     QString resource = "/distributions";
-    QNetworkReply *reply = request(resource);
-    reply->setProperty("reqtype", OBSCore::Distributions);
+    RequestContext context(OBSCore::Distributions);
+    context.onSuccess = [this](const QByteArray &data) {
+        parse([data](OBSXmlReader *reader) {
+            reader->parseDistributions(data);
+        });
+    };
+    request(resource, context);
+}
+
+OBSRequestHandle OBSCore::watchBuildResults(const QString &project, const QStringList &packages, const QString &oldState)
+{
+    OBSRequestHandle handle = OBSRequestHandle::create();
+    if (!invokeInNetworkThread([this, project, packages, oldState, handle]() {
+        watchBuildResults(project, packages, oldState, handle);
+    })) {
+        watchBuildResults(project, packages, oldState, handle);
+    }
+    return handle;
+}
+
+void OBSCore::watchBuildResults(const QString &project, const QStringList &packages, const QString &oldState,
+                                const OBSRequestHandle &handle)
+{
+    // The server holds the request until the state differs from oldState
+    QStringList query;
+    for (const QString &package : packages) {
+        query.append("package=" + QString::fromLatin1(QUrl::toPercentEncoding(package)));
+    }
+    if (!oldState.isEmpty()) {
+        query.append("oldstate=" + QString::fromLatin1(QUrl::toPercentEncoding(oldState)));
+    }
+    QString resource = QString("%1/_result?%2").arg(project, query.join("&"));
+
+    RequestContext context(OBSCore::WatchBuildResults);
+    context.longPoll = !oldState.isEmpty();
+    context.handle = handle;
+    context.onSuccess = [this, project, handle](const QByteArray &data) {
+        // <resultlist>
+        parse([this, project, handle, data](OBSXmlReader *reader) {
+            QString state = reader->parseResultListState(data);
+            QMetaObject::invokeMethod(this, [this, project, state, handle]() {
+                emit buildResultsState(project, state, handle);
+            }, Qt::QueuedConnection);
+        }, handle);
+    };
+    context.onError = [this, project, handle](const QByteArray &) {
+        emit buildResultsWatchFailed(project, handle);
+    };
+    context.onNotFound = context.onError;
+    requestBuild(resource, context);
 }
 
 void OBSCore::onSslErrors(QNetworkReply *reply, const QList<QSslError> &list)
@@ -1056,6 +2753,10 @@ void OBSCore::onSslErrors(QNetworkReply *reply, const QList<QSslError> &list)
             errorString = sslError.errorString();
             if (sslError.error() == QSslError::SelfSignedCertificateInChain) {
                 qDebug() << "OBSCore::onSslErrors() Self signed certificate!";
+                if (networkThread) {
+                    // The GUI answers later, the handshake fails meanwhile
+                    heldReplies.insert(reply);
+                }
                 emit selfSignedCertificate(reply);
             }
         }
@@ -1068,5 +2769,6 @@ void OBSCore::onSslErrors(QNetworkReply *reply, const QList<QSslError> &list)
         message=list.count()+tr(" SSL errors have occured: %1");
     }
 
-   qDebug() << "OBSCore::onSslErrors() url:" << reply->url() << "row:" << reply->property("row").toInt();
+   qDebug() << "OBSCore::onSslErrors() url:" << reply->url()
+            << "request type:" << requestContexts.value(reply).type;
 }
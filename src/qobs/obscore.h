@@ -28,10 +28,25 @@
 #include <QAuthenticator>
 #include <QNetworkReply>
 #include <QSslError>
+#include <QSslConfiguration>
 #include <QDebug>
 #include <QEventLoop>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QSharedPointer>
+#include <QThread>
+#include <QMutex>
+#include <QCoreApplication>
+#include <functional>
 #include "obsxmlreader.h"
 #include "obslinkhelper.h"
+#include "obsrequestscheduler.h"
+#include "obsdiskcache.h"
+#include "obsblobstore.h"
+#include "obsrequesthandle.h"
+#include "obscircuitbreaker.h"
+#include "obscookiejar.h"
 
 class OBSCore : public QObject
 {
@@ -40,30 +55,37 @@ class OBSCore : public QObject
 public:
     static OBSCore* getInstance();
     bool isAuthenticated();
-    QString getUsername();
+    QString getUsername() const;
     void setApiUrl(const QString &apiUrl);
     QString getApiUrl() const;
+    void prewarmConnection();
+    bool isHttp2Enabled() const;
+    void setHttp2Enabled(bool enabled);
+    void setMaxConnections(int maxConnections);
     void login();
-    QNetworkReply *request(const QString &resource);
+    void request(const QString &resource);
     void request(QNetworkReply *reply);
-    QNetworkReply *requestBuild(const QString &resource);
+    void requestBuild(const QString &resource);
     void getBuildStatus(const QStringList &build, int row);
-    QNetworkReply *requestSource(const QString &resource);
+    void getProjectBuildStatus(const QString &project, const QList<QStringList> &builds, const QList<int> &rows);
+    void requestSource(const QString &resource);
     void getIncomingRequests();
     void getOutgoingRequests();
     void getDeclinedRequests();
-    QNetworkReply *postRequest(const QString &resource, const QByteArray &data, const QString &contentTypeHeader);
-    QNetworkReply *putRequest(const QString &resource, const QByteArray &data);
-    QNetworkReply *deleteRequest(const QString &resource);
+    void postRequest(const QString &resource, const QByteArray &data, const QString &contentTypeHeader);
+    void putRequest(const QString &resource, const QByteArray &data);
+    void deleteRequest(const QString &resource);
     bool isIncludeHomeProjects() const;
     void setIncludeHomeProjects(bool value);
     void getProjects();
     void getProjectMetaConfig(const QString &resource);
     void getPackageMetaConfig(const QString &resource);
-    void getPackages(const QString &resource);
-    void getFiles(const QString &project, const QString &package);
+    OBSRequestHandle getPackages(const QString &resource);
+    OBSRequestHandle getFiles(const QString &project, const QString &package);
+    OBSRequestHandle getFileMd5List(const QString &project, const QString &package);
     void getLink(const QString &project, const QString &package);
-    void getAllBuildStatus(const QString &resource);
+    OBSRequestHandle getAllBuildStatus(const QString &resource);
+    void cancelRequest(const OBSRequestHandle &handle);
     void changeSubmitRequest(const QString &resource, const QByteArray &data);
     void request(const QString &resource, int row);
     void getSRDiff(const QString &resource);
@@ -75,7 +97,21 @@ public:
     void createProject(const QString &project, const QByteArray &data);
     void createPackage(const QString &project, const QString &package, const QByteArray &data);
     void uploadFile(const QString &project, const QString &package, const QString &fileName, const QByteArray &data);
-    void downloadFile(const QString &project, const QString &package, const QString &fileName);
+    OBSRequestHandle uploadFile(const QString &project, const QString &package, const QString &fileName,
+                                const QString &path);
+    OBSRequestHandle commitFiles(const QString &project, const QString &package, const QStringList &paths,
+                                 const QString &comment);
+    OBSRequestHandle downloadFilePart(const QString &project, const QString &package, const QString &fileName,
+                                      const QString &path, qint64 offset);
+    OBSRequestHandle downloadFile(const QString &project, const QString &package, const QString &fileName,
+                                  const QString &path);
+    OBSRequestHandle downloadPackage(const QString &project, const QString &package, const QString &directory);
+    OBSRequestHandle getFileContents(const QString &project, const QString &package, const QString &fileName,
+                                     const QString &md5);
+    OBSRequestHandle getBinaryList(const QString &project, const QString &repository, const QString &arch,
+                                   const QString &package);
+    OBSRequestHandle downloadBinaries(const QString &project, const QString &repository, const QString &arch,
+                                      const QString &package, const QStringList &binaries, const QString &directory);
     void getBuildLog(const QString &project, const QString &repository, const QString &arch, const QString &package);
     void deleteProject(const QString &project);
     void deletePackage(const QString &project, const QString &package);
@@ -84,6 +120,13 @@ public:
     void getPerson();
     void updatePerson(const QByteArray &data);
     void getDistributions();
+    OBSRequestHandle watchBuildResults(const QString &project, const QStringList &packages, const QString &oldState);
+    OBSRequestScheduler *getRequestScheduler() const;
+    OBSCircuitBreaker *getCircuitBreaker() const;
+    OBSBlobStore *getBlobStore() const;
+    void startNetworkThread();
+    bool isNetworkThreadRunning() const;
+    void answerSelfSignedCertificate(QNetworkReply *reply, bool accepted);
 
 signals:
     void apiNotFound(QUrl url);
@@ -91,7 +134,28 @@ signals:
     void selfSignedCertificate(QNetworkReply *reply);
     void networkError(const QString &error);
     void srDiffFetched(const QString &diff);
-    void fileFetched(const QString &fileName, const QByteArray &data);
+    void fileUploadProgress(const QString &path, qint64 bytesSent, qint64 bytesTotal);
+    void fileUploadFinished(const QString &path);
+    void fileDownloadProgress(const QString &path, qint64 bytesReceived, qint64 bytesTotal);
+    void fileDownloaded(const QString &path);
+    void fileDownloadFailed(const QString &path, const QString &errorString);
+    void fileDownloadInterrupted(const QString &path);
+    void archiveDownloadProgress(const QString &directory, qint64 bytesReceived, qint64 bytesTotal);
+    void archiveDownloaded(const QString &directory, const QStringList &files);
+    void archiveDownloadFailed(const QString &directory, const QString &errorString);
+    void fileContentsFetched(const QString &project, const QString &package, const QString &fileName,
+                             const QByteArray &data);
+    void fileContentsFailed(const QString &project, const QString &package, const QString &fileName,
+                            const QString &errorString);
+    void sessionReset();
+    void commitProgress(const QString &project, const QString &package, const QString &message);
+    void commitFailed(const QString &project, const QString &package, const QString &errorString);
+    void nothingToCommit(const QString &project, const QString &package);
+    void filesCommitted(const QString &project, const QString &package, const QString &srcmd5,
+                        const QHash<QString, QString> &files);
+    void fileMd5ListFetched(const QString &project, const QString &package, const QString &srcmd5,
+                            const QHash<QString, QString> &files);
+    void fileMd5ListFailed(const QString &project, const QString &package, const QString &errorString);
     void buildLogFetched(const QString &buildLog);
     void buildLogNotFound();
     void projectNotFound(OBSStatus *status);
@@ -104,6 +168,8 @@ signals:
     void cannotDeleteProject(OBSStatus *obsStatus);
     void cannotDeletePackage(OBSStatus *obsStatus);
     void cannotDeleteFile(OBSStatus *obsStatus);
+    void buildResultsState(const QString &project, const QString &state, const OBSRequestHandle &handle);
+    void buildResultsWatchFailed(const QString &project, const OBSRequestHandle &handle);
 
 public slots:
     void setCredentials(const QString&, const QString&);
@@ -113,24 +179,59 @@ private slots:
     void provideAuthentication(QNetworkReply *reply, QAuthenticator* ator);
     void replyFinished(QNetworkReply *reply);
     void onSslErrors(QNetworkReply *reply, const QList<QSslError> &list);
+    void storeSslSession(QNetworkReply *reply);
 
 private:
+/*
+ * OBSCore can run on its own thread (see startNetworkThread()), so that the
+ * network doesn't wait for busy widgets. Its public methods can be called from
+ * any thread: requests are queued to the network thread, in the order they
+ * are made, and the state read by the GUI is guarded by a mutex. Signals
+ * reach the GUI through queued connections.
+ *
+ * The network thread never waits for the GUI: a reply with a self-signed
+ * certificate is held after its handshake fails and sent again once the
+ * certificate is accepted, see answerSelfSignedCertificate().
+ *
+ */
+    QThread *networkThread;
+    mutable QMutex mutex;
+    bool invokeInNetworkThread(const std::function<void()> &call);
+    void resetSession();
+    void setAuthenticated(bool authenticated);
 /*
  * We need to instantiate QNAM only once, as it should be used as
  * as singleton or a utility instead of recreating it for each
  * request. This class (OBSCore) uses the singleton pattern to
- * achieve this.
+ * achieve this. It's kept on login too, so the connection opened by
+ * prewarmConnection() is reused, and the TLS session is stored on disk
+ * to abbreviate the handshakes of the next run.
  *
  */
     QNetworkAccessManager *manager;
     void createManager();
+    QNetworkAccessManager *getManager();
+    QString sessionUsername;
+    QSet<QNetworkReply *> discardedReplies;
+    QSet<QNetworkReply *> heldReplies; // waiting for answerSelfSignedCertificate()
+    QString sslSessionHost;
+    QByteArray sslSessionTicket;
+    QSslConfiguration sslConfiguration() const;
+    static QString sslSessionFileName(const QUrl &url);
+    void loadSslSession(const QUrl &url);
+    bool http2Enabled;
+    bool http2Unavailable;
+    int http2Replies;
+    int http1Replies;
+    void allowHttp2(QNetworkRequest &request) const;
+    static bool isHttp2Failure(QNetworkReply *reply);
     OBSCore();
     static OBSCore *instance;
     QString curUsername;
     QString curPassword;
-    QString prevPassword;
-    QString prevUsername;
     QString apiUrl;
+    QNetworkRequest createNetworkRequest(const QString &resource) const;
+    OBSRequestScheduler *scheduler;
     enum RequestType {
         Login,
         ProjectList,
@@ -161,8 +262,190 @@ private:
         About,
         Person,
         UpdatePerson,
-        Distributions
+        Distributions,
+        WatchBuildResults,
+        CommitFileList,
+        DownloadPackage,
+        BinaryList,
+        DownloadBinaries,
+        FileContents,
+        FileMd5List
+    };
+
+/*
+ * Every request issued by OBSCore carries a RequestContext. It is created
+ * when the request is sent, holds the handlers that process the reply and
+ * is looked up by reply in replyFinished(), so dispatching a reply is just
+ * a call to the matching handler.
+ *
+ * GETs are coalesced: while a GET is queued or in flight, an identical one
+ * (same type, URL and tag) is not sent again. The reader broadcasts its
+ * results, so one reply completes every waiter.
+ *
+ * Conditional GETs send the ETag/Last-Modified validators of the previous
+ * reply. On 304 Not Modified, onNotModified replays the previous result, or
+ * onSuccess is called with the previous body if there is no such handler.
+ * Their replies are also kept in an OBSDiskCache, so the first conditional
+ * GET of a session shows the cached result at once and a network error
+ * falls back to it.
+ *
+ * Replies of contexts with onReadyRead are parsed as they arrive, and the
+ * raw body of conditional ones is written to the disk cache as it arrives.
+ * Their read buffer is bounded, so a large reply is never held in memory as
+ * a whole, neither in QNAM nor here.
+ *
+ * Long-poll requests bypass the scheduler, as they would hold one of its
+ * slots for minutes.
+ *
+ * Replies stalled for longer than the timeout of their type are aborted.
+ * GETs that fail with a transient error (timeout, connection error, 429 or
+ * 5xx) are sent again with jittered exponential backoff, or after the delay
+ * given by Retry-After. Transient errors feed an OBSCircuitBreaker, which
+ * pauses background requests while it is open. Failed background requests
+ * are not reported with networkError().
+ *
+ * Requests with an OBSRequestHandle can be cancelled: a queued one is never
+ * sent, one in flight is aborted and their replies are dropped before they
+ * are parsed. An identical request joins the handle of the one in flight,
+ * which is only aborted once all of its waiters have been cancelled.
+ *
+ * Handlers don't parse on the GUI thread: parse() runs the job on the parser
+ * thread with a new OBSXmlReader, whose signals are queued to the
+ * OBSXmlReader singleton. Jobs run in the order they are posted, so the
+ * chunks of a streamed reply reach its OBSListParser in order. Results that
+ * OBSCore itself needs are posted back to the GUI thread.
+ *
+ */
+    typedef std::function<void(const QByteArray &data)> ReplyHandler;
+    typedef std::function<void(qint64 bytes, qint64 bytesTotal)> ProgressHandler;
+    struct RequestContext {
+        explicit RequestContext(RequestType type = Login) :
+            type(type), conditional(false), servedStale(false), longPoll(false), attempt(0) {}
+        RequestType type;
+        QString tag; // tells apart GETs to the same URL with different handlers
+        QString key;
+        OBSRequestHandle handle; // null unless the request can be cancelled
+        bool conditional;
+        bool servedStale;
+        bool longPoll;
+        int attempt;
+        OBSRequestScheduler::SendFunction send;
+        ReplyHandler onReadyRead; // body chunks of a 200 reply, onSuccess gets the rest
+        ReplyHandler onSuccess;
+        ReplyHandler onNotModified; // 304
+        ReplyHandler onNotFound; // 404
+        ReplyHandler onBadRequest; // 400
+        ReplyHandler onAccessDenied; // 401
+        ReplyHandler onError; // other errors, instead of networkError()
+        ProgressHandler onProgress; // download or upload progress
+        QHash<QByteArray, QByteArray> headers; // extra request headers
+        std::function<void(QNetworkReply *reply)> onMetaData; // status and headers, before the body
+    };
+    QHash<QNetworkReply *, RequestContext> requestContexts;
+    QHash<QString, int> inFlightGets;
+    QHash<QString, OBSRequestHandle> inFlightHandles; // of cancellable GETs
+    void releaseInFlightGet(const RequestContext &context);
+    QHash<QNetworkReply *, OBSDiskCacheEntry *> streamedBodies; // null unless conditional
+    QSet<QNetworkReply *> timedOutReplies;
+    OBSCircuitBreaker *circuitBreaker;
+    OBSCookieJar *cookieJar;
+    QString cookieFileName() const;
+    QByteArray authorizationHeader() const;
+    quint32 sessionGeneration;
+    static int timeoutForType(RequestType type);
+    static bool isTransientError(QNetworkReply *reply, int httpStatusCode, bool timedOut);
+    static int retryAfter(QNetworkReply *reply);
+    static int retryDelay(int attempt, int retryAfter);
+    void retry(const RequestContext &context, int delay);
+    void registerReply(QNetworkReply *reply, const RequestContext &context);
+    void replyReadyRead(QNetworkReply *reply);
+    QHash<QString, OBSCachedResponse> resourceCache;
+    OBSDiskCache *diskCache;
+    OBSBlobStore *blobStore;
+    QHash<QString, QStringList> projectLists;
+    QHash<QString, QStringList> packageLists;
+    QString diskCacheKey(const QString &key) const;
+    void storeResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &data);
+    void storeStreamedResponse(QNetworkReply *reply, const RequestContext &context, OBSDiskCacheEntry *entry,
+                               const QByteArray &data);
+    bool serveCachedResponse(const RequestContext &context);
+    static OBSRequestScheduler::Priority priorityForType(RequestType type);
+    void schedule(const OBSRequestScheduler::SendFunction &send);
+    void schedule(const OBSRequestScheduler::SendFunction &send, const RequestContext &context);
+    QNetworkReply *sendGet(const QNetworkRequest &request);
+    QNetworkReply *sendPost(const QString &resource, const QByteArray &data, const QString &contentTypeHeader);
+    QNetworkReply *sendPut(const QString &resource, const QByteArray &data);
+    QNetworkReply *sendDelete(const QString &resource);
+    void request(const QString &resource, const RequestContext &context);
+    void requestBuild(const QString &resource, const RequestContext &context);
+    void requestSource(const QString &resource, const RequestContext &context);
+    void postRequest(const QString &resource, const QByteArray &data,
+                     const QString &contentTypeHeader, const RequestContext &context);
+    void putRequest(const QString &resource, const QByteArray &data, const RequestContext &context);
+    void deleteRequest(const QString &resource, const RequestContext &context);
+    RequestContext buildStatusContext(int row);
+    void resend(const QNetworkRequest &request, bool hasContext, const RequestContext &context);
+    QThread *parserThread;
+    QObject *parserWorker;
+    void parse(const std::function<void(OBSXmlReader *reader)> &job);
+    void parse(const std::function<void(OBSXmlReader *reader)> &job, const OBSRequestHandle &handle);
+    void getPackages(const QString &resource, const OBSRequestHandle &handle);
+    void getFiles(const QString &project, const QString &package, const OBSRequestHandle &handle);
+    void getFileMd5List(const QString &project, const QString &package, const OBSRequestHandle &handle);
+    void getAllBuildStatus(const QString &resource, const OBSRequestHandle &handle);
+    void watchBuildResults(const QString &project, const QStringList &packages, const QString &oldState,
+                           const OBSRequestHandle &handle);
+    void downloadFile(const QString &project, const QString &package, const QString &fileName,
+                      const QString &path, const OBSRequestHandle &handle);
+    void uploadFile(const QString &project, const QString &package, const QString &fileName,
+                    const QString &path, const OBSRequestHandle &handle);
+    void downloadFilePart(const QString &project, const QString &package, const QString &fileName,
+                          const QString &path, qint64 offset, const OBSRequestHandle &handle);
+    void downloadPackage(const QString &project, const QString &package, const QString &directory,
+                         const OBSRequestHandle &handle);
+    void getBinaryList(const QString &project, const QString &repository, const QString &arch,
+                       const QString &package, const OBSRequestHandle &handle);
+    void getFileContents(const QString &project, const QString &package, const QString &fileName,
+                         const QString &md5, const OBSRequestHandle &handle);
+    void downloadBinaries(const QString &project, const QString &repository, const QString &arch,
+                          const QString &package, const QStringList &binaries, const QString &directory,
+                          const OBSRequestHandle &handle);
+    void downloadArchive(const QString &resource, RequestType type, const QString &directory,
+                         const QString &notFoundError, const OBSRequestHandle &handle);
+
+/*
+ * A commit sends the md5 of every file with cmd=commitfilelist. The server
+ * answers with the files whose contents it doesn't have, which are uploaded
+ * with rev=repository (no revision is created), and the list is sent again.
+ * Local files are hashed on the global thread pool while the current file
+ * list is fetched, and the uploads run in parallel, within the limits of
+ * the scheduler.
+ *
+ */
+    struct CommitState {
+        CommitState() : pendingHashes(0), listed(false), pendingUploads(0), rounds(0), failed(false) {}
+        QString project;
+        QString package;
+        QString comment;
+        OBSRequestHandle handle;
+        QHash<QString, QString> localFiles; // name -> path
+        QHash<QString, QString> localMd5s;
+        QHash<QString, QString> remoteMd5s;
+        QHash<QString, QString> committedMd5s;
+        int pendingHashes;
+        bool listed;
+        int pendingUploads;
+        int rounds;
+        bool failed;
     };
+    typedef QSharedPointer<CommitState> CommitStatePtr;
+    void commitFiles(const QString &project, const QString &package, const QStringList &paths,
+                     const QString &comment, const OBSRequestHandle &handle);
+    void sendCommitFileList(CommitStatePtr state);
+    void uploadMissingFiles(CommitStatePtr state, const QStringList &missingFiles);
+    void failCommit(CommitStatePtr state, const QString &errorString);
+    void failCommit(CommitStatePtr state, const QByteArray &data, const QString &errorString);
+    QNetworkReply *sendPut(const QString &resource, QIODevice *device);
     bool authenticated;
     OBSXmlReader *xmlReader;
     bool includeHomeProjects;
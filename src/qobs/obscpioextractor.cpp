@@ -0,0 +1,213 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obscpioextractor.h"
+#include <QDir>
+#include <QDebug>
+
+// Magic, 13 fields of 8 hex digits
+static const int headerSize = 110;
+static const quint32 fileTypeMask = 0170000;
+static const quint32 regularFile = 0100000;
+
+static int padding(quint32 size)
+{
+    // Headers and file data are aligned to 4 bytes
+    return (4 - size % 4) % 4;
+}
+
+OBSCpioExtractor::OBSCpioExtractor(const QString &directory) :
+    m_state(Header),
+    m_directory(directory),
+    m_mode(0),
+    m_nameSize(0),
+    m_fileSize(0),
+    m_remaining(0),
+    m_skip(0)
+{
+}
+
+bool OBSCpioExtractor::addData(const QByteArray &data)
+{
+    int pos = 0;
+
+    while (pos < data.size() && m_state != Finished && m_state != Error) {
+        int available = data.size() - pos;
+
+        if (m_skip > 0) {
+            int n = qMin(m_skip, available);
+            pos += n;
+            m_skip -= n;
+            continue;
+        }
+
+        switch (m_state) {
+        case Header: {
+            int n = qMin(headerSize - m_buffer.size(), available);
+            m_buffer.append(data.constData() + pos, n);
+            pos += n;
+            if (m_buffer.size() == headerSize) {
+                if (parseHeader()) {
+                    m_buffer.clear();
+                    m_state = Name;
+                }
+            }
+            break;
+        }
+        case Name: {
+            int n = qMin(int(m_nameSize) - m_buffer.size(), available);
+            m_buffer.append(data.constData() + pos, n);
+            pos += n;
+            if (m_buffer.size() == int(m_nameSize)) {
+                // The name size includes the trailing NUL
+                m_fileName = QString::fromUtf8(m_buffer.constData(), m_buffer.size() - 1);
+                m_buffer.clear();
+                m_skip = padding(headerSize + m_nameSize);
+                startEntry();
+            }
+            break;
+        }
+        case Data: {
+            int n = int(qMin(quint32(available), m_remaining));
+            if (m_file && m_file->write(data.constData() + pos, n) != n) {
+                setError(QString("Cannot write %1: %2").arg(m_file->fileName(), m_file->errorString()));
+                break;
+            }
+            pos += n;
+            m_remaining -= n;
+            if (m_remaining == 0) {
+                finishEntry();
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return m_state != Error;
+}
+
+bool OBSCpioExtractor::isFinished() const
+{
+    return m_state == Finished;
+}
+
+bool OBSCpioExtractor::hasError() const
+{
+    return m_state == Error;
+}
+
+QString OBSCpioExtractor::errorString() const
+{
+    return m_errorString;
+}
+
+QStringList OBSCpioExtractor::getFiles() const
+{
+    return m_files;
+}
+
+bool OBSCpioExtractor::parseHeader()
+{
+    if (!m_buffer.startsWith("070701") && !m_buffer.startsWith("070702")) {
+        setError("Invalid cpio header");
+        return false;
+    }
+
+    // ino, mode, uid, gid, nlink, mtime, filesize, devmajor, devminor,
+    // rdevmajor, rdevminor, namesize, check
+    quint32 fields[13];
+    for (int i = 0; i < 13; ++i) {
+        bool ok;
+        fields[i] = m_buffer.mid(6 + i * 8, 8).toUInt(&ok, 16);
+        if (!ok) {
+            setError("Invalid cpio header");
+            return false;
+        }
+    }
+    m_mode = fields[1];
+    m_fileSize = fields[6];
+    m_nameSize = fields[11];
+
+    if (m_nameSize < 2 || m_nameSize > 4096) {
+        setError("Invalid cpio header");
+        return false;
+    }
+    return true;
+}
+
+bool OBSCpioExtractor::startEntry()
+{
+    if (m_fileName == "TRAILER!!!") {
+        // Whatever follows is just padding to a whole block
+        m_state = Finished;
+        return true;
+    }
+
+    // Package sources are a flat list of files
+    if (m_fileName.contains('/') || m_fileName.contains('\\') || m_fileName == "." || m_fileName == "..") {
+        setError(QString("Invalid file name in cpio archive: %1").arg(m_fileName));
+        return false;
+    }
+
+    if ((m_mode & fileTypeMask) == regularFile) {
+        m_file.reset(new QSaveFile(QDir(m_directory).filePath(m_fileName)));
+        if (!m_file->open(QIODevice::WriteOnly)) {
+            setError(QString("Cannot open %1: %2").arg(m_file->fileName(), m_file->errorString()));
+            return false;
+        }
+    } else {
+        qDebug() << "OBSCpioExtractor::startEntry() Skipping" << m_fileName;
+    }
+
+    m_remaining = m_fileSize;
+    m_state = Data;
+    if (m_remaining == 0) {
+        return finishEntry();
+    }
+    return true;
+}
+
+bool OBSCpioExtractor::finishEntry()
+{
+    if (m_file) {
+        if (!m_file->commit()) {
+            setError(QString("Cannot write %1: %2").arg(m_file->fileName(), m_file->errorString()));
+            return false;
+        }
+        m_file.reset();
+        m_files.append(m_fileName);
+    }
+
+    // After the padding of the name, if the file is empty
+    m_skip += padding(m_fileSize);
+    m_state = Header;
+    return true;
+}
+
+void OBSCpioExtractor::setError(const QString &errorString)
+{
+    qDebug() << "OBSCpioExtractor::setError()" << errorString;
+    m_errorString = errorString;
+    m_state = Error;
+    // Discards the temporary file
+    m_file.reset();
+}
@@ -0,0 +1,75 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSCPIOEXTRACTOR_H
+#define OBSCPIOEXTRACTOR_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QSaveFile>
+#include <QScopedPointer>
+
+/*
+ * OBSCpioExtractor extracts a "newc" cpio archive, such as the one sent
+ * by /source/<project>/<package>?view=cpio, as it arrives. Each file is
+ * written to a temporary file in directory, which replaces the old one
+ * once the file is complete, so memory use doesn't depend on the size of
+ * the package. Only regular files with a plain name are extracted, other
+ * entries are skipped and a name with a path makes the archive invalid.
+ *
+ */
+class OBSCpioExtractor
+{
+
+public:
+    explicit OBSCpioExtractor(const QString &directory);
+    bool addData(const QByteArray &data);
+    bool isFinished() const;
+    bool hasError() const;
+    QString errorString() const;
+    QStringList getFiles() const;
+
+private:
+    enum State {
+        Header,
+        Name,
+        Data,
+        Finished,
+        Error
+    };
+    State m_state;
+    QString m_directory;
+    QByteArray m_buffer;
+    QScopedPointer<QSaveFile> m_file;
+    QString m_fileName;
+    quint32 m_mode;
+    quint32 m_nameSize;
+    quint32 m_fileSize;
+    quint32 m_remaining;
+    int m_skip;
+    QString m_errorString;
+    QStringList m_files;
+    bool parseHeader();
+    bool startEntry();
+    bool finishEntry();
+    void setError(const QString &errorString);
+};
+
+#endif // OBSCPIOEXTRACTOR_H
@@ -0,0 +1,205 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obsdiskcache.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+
+// The body is stored as compressed chunks, ended by an empty one
+static const quint32 cacheFormatVersion = 2;
+static const int chunkSize = 256 * 1024;
+
+OBSDiskCache::OBSDiskCache(const QString &directory) :
+    m_directory(directory),
+    m_maximumSize(50 * 1024 * 1024),
+    m_currentSize(-1)
+{
+    if (m_directory.isEmpty()) {
+        m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/responses";
+    }
+    // Responses may list private projects, only the user can read them
+    QDir().mkpath(m_directory);
+    QFile::setPermissions(m_directory, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+}
+
+QString OBSDiskCache::getDirectory() const
+{
+    return m_directory;
+}
+
+qint64 OBSDiskCache::getMaximumSize() const
+{
+    return m_maximumSize;
+}
+
+void OBSDiskCache::setMaximumSize(qint64 maximumSize)
+{
+    m_maximumSize = maximumSize;
+    expire();
+}
+
+QString OBSDiskCache::fileName(const QString &key) const
+{
+    QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_directory + "/" + QString::fromLatin1(hash) + ".cache";
+}
+
+bool OBSDiskCache::read(const QString &key, OBSCachedResponse &response) const
+{
+    QFile file(fileName(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 version;
+    stream >> version;
+    if (version != cacheFormatVersion) {
+        qDebug() << "OBSDiskCache::read() Discarding stale entry for" << key;
+        return false;
+    }
+    QString storedKey;
+    stream >> storedKey;
+    if (storedKey != key) {
+        qDebug() << "OBSDiskCache::read() Discarding stale entry for" << key;
+        return false;
+    }
+    stream >> response.etag >> response.lastModified;
+
+    response.data.clear();
+    while (stream.status() == QDataStream::Ok) {
+        QByteArray chunk;
+        stream >> chunk;
+        if (chunk.isEmpty()) {
+            break;
+        }
+        response.data.append(qUncompress(chunk));
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+void OBSDiskCache::write(const QString &key, const OBSCachedResponse &response)
+{
+    OBSDiskCacheEntry entry(this, key, response.etag, response.lastModified);
+    entry.append(response.data);
+    entry.commit();
+}
+
+void OBSDiskCache::entryWritten(qint64 sizeDelta)
+{
+    if (m_currentSize >= 0) {
+        m_currentSize += sizeDelta;
+    }
+    expire();
+}
+
+void OBSDiskCache::remove(const QString &key)
+{
+    QString name = fileName(key);
+    qint64 size = QFileInfo(name).size();
+    if (QFile::remove(name) && m_currentSize >= 0) {
+        m_currentSize -= size;
+    }
+}
+
+void OBSDiskCache::clear()
+{
+    QDir dir(m_directory);
+    for (const QString &entry : dir.entryList(QStringList() << "*.cache", QDir::Files)) {
+        dir.remove(entry);
+    }
+    m_currentSize = 0;
+}
+
+void OBSDiskCache::expire()
+{
+    if (m_currentSize >= 0 && m_currentSize <= m_maximumSize) {
+        return;
+    }
+
+    QDir dir(m_directory);
+    QFileInfoList entries = dir.entryInfoList(QStringList() << "*.cache", QDir::Files, QDir::Time);
+
+    if (m_currentSize < 0) {
+        m_currentSize = 0;
+        for (const QFileInfo &entry : entries) {
+            m_currentSize += entry.size();
+        }
+    }
+
+    // Oldest entries are at the end of the list
+    while (m_currentSize > m_maximumSize && !entries.isEmpty()) {
+        QFileInfo entry = entries.takeLast();
+        if (dir.remove(entry.fileName())) {
+            qDebug() << "OBSDiskCache::expire() Removed" << entry.fileName();
+            m_currentSize -= entry.size();
+        }
+    }
+}
+
+OBSDiskCacheEntry::OBSDiskCacheEntry(OBSDiskCache *cache, const QString &key, const QByteArray &etag,
+                                     const QByteArray &lastModified) :
+    m_cache(cache),
+    m_file(cache->fileName(key))
+{
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        qDebug() << "OBSDiskCacheEntry::OBSDiskCacheEntry() Cannot open" << m_file.fileName() << m_file.errorString();
+    }
+    m_file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    m_stream.setDevice(&m_file);
+    m_stream << cacheFormatVersion << key << etag << lastModified;
+}
+
+void OBSDiskCacheEntry::append(const QByteArray &data)
+{
+    m_buffer.append(data);
+    if (m_buffer.size() >= chunkSize) {
+        flush();
+    }
+}
+
+void OBSDiskCacheEntry::flush()
+{
+    if (!m_buffer.isEmpty()) {
+        m_stream << qCompress(m_buffer);
+        m_buffer.clear();
+    }
+}
+
+bool OBSDiskCacheEntry::commit()
+{
+    flush();
+    m_stream << QByteArray();
+
+    QString name = m_file.fileName();
+    qint64 oldSize = QFileInfo(name).size();
+    if (m_stream.status() != QDataStream::Ok || !m_file.commit()) {
+        qDebug() << "OBSDiskCacheEntry::commit() Cannot write" << name << m_file.errorString();
+        return false;
+    }
+    m_cache->entryWritten(QFileInfo(name).size() - oldSize);
+    return true;
+}
@@ -0,0 +1,91 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSDISKCACHE_H
+#define OBSDISKCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QSaveFile>
+#include <QDataStream>
+
+class OBSDiskCacheEntry;
+
+struct OBSCachedResponse {
+    QByteArray etag;
+    QByteArray lastModified;
+    QByteArray data;
+};
+
+/*
+ * OBSDiskCache keeps compressed GET responses on disk so that views can be
+ * populated at startup, and when the network is down, before the server
+ * has answered. Once the cache grows over its maximum size the least
+ * recently written entries are removed.
+ *
+ */
+class OBSDiskCache
+{
+
+public:
+    explicit OBSDiskCache(const QString &directory = QString());
+    QString getDirectory() const;
+    qint64 getMaximumSize() const;
+    void setMaximumSize(qint64 maximumSize);
+    bool read(const QString &key, OBSCachedResponse &response) const;
+    void write(const QString &key, const OBSCachedResponse &response);
+    void remove(const QString &key);
+    void clear();
+
+private:
+    friend class OBSDiskCacheEntry;
+    QString m_directory;
+    qint64 m_maximumSize;
+    qint64 m_currentSize;
+    QString fileName(const QString &key) const;
+    void entryWritten(qint64 sizeDelta);
+    void expire();
+};
+
+/*
+ * OBSDiskCacheEntry writes a response to an OBSDiskCache as its body
+ * arrives, so that a large body is never kept in memory as a whole. It goes
+ * to a temporary file, which replaces the cached entry on commit() and is
+ * discarded otherwise.
+ *
+ */
+class OBSDiskCacheEntry
+{
+
+public:
+    OBSDiskCacheEntry(OBSDiskCache *cache, const QString &key, const QByteArray &etag,
+                      const QByteArray &lastModified);
+    void append(const QByteArray &data);
+    bool commit();
+
+private:
+    OBSDiskCache *m_cache;
+    QSaveFile m_file;
+    QDataStream m_stream;
+    QByteArray m_buffer;
+    void flush();
+};
+
+#endif // OBSDISKCACHE_H
@@ -0,0 +1,438 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obsdownloadmanager.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QTimer>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+
+static const quint32 queueFormatVersion = 1;
+
+OBSDownloadManager::OBSDownloadManager(QObject *parent) : QObject(parent),
+    m_obsCore(OBSCore::getInstance()),
+    m_nextId(1),
+    m_maxParallel(2),
+    m_maxAttempts(10),
+    m_authenticated(m_obsCore->isAuthenticated())
+{
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/downloads";
+    QDir().mkpath(directory);
+    m_queueFileName = directory + "/queue";
+
+    m_verifierThread = new QThread(this);
+    m_verifierThread->setObjectName("OBSDownloadVerifier");
+    m_verifier = new QObject();
+    m_verifier->moveToThread(m_verifierThread);
+    connect(m_verifierThread, &QThread::finished, m_verifier, &QObject::deleteLater);
+    m_verifierThread->start();
+
+    // isAuthenticated() is also a getter of OBSCore
+    connect(m_obsCore, SIGNAL(isAuthenticated(bool)), this, SLOT(slotAuthenticated(bool)));
+    connect(m_obsCore, &OBSCore::sessionReset, this, &OBSDownloadManager::slotSessionReset);
+    connect(m_obsCore, &OBSCore::fileDownloadProgress, this, &OBSDownloadManager::slotProgress);
+    connect(m_obsCore, &OBSCore::fileDownloaded, this, &OBSDownloadManager::slotDownloaded);
+    connect(m_obsCore, &OBSCore::fileDownloadFailed, this, &OBSDownloadManager::slotFailed);
+    connect(m_obsCore, &OBSCore::fileDownloadInterrupted, this, &OBSDownloadManager::slotInterrupted);
+
+    load();
+}
+
+OBSDownloadManager::~OBSDownloadManager()
+{
+    m_verifierThread->quit();
+    m_verifierThread->wait();
+}
+
+int OBSDownloadManager::enqueue(const QString &project, const QString &package, const QString &fileName,
+                                const QString &path, const QString &md5)
+{
+    Download download;
+    download.id = m_nextId++;
+    download.project = project;
+    download.package = package;
+    download.fileName = fileName;
+    download.path = path;
+    download.md5 = md5;
+    download.bytesReceived = QFileInfo(partPath(path)).size();
+    qDebug() << __PRETTY_FUNCTION__ << download.id << project << package << fileName << "->" << path;
+
+    m_downloads.insert(download.id, download);
+    save();
+    emit downloadChanged(download.id);
+    dispatch();
+    return download.id;
+}
+
+void OBSDownloadManager::pause(int id)
+{
+    if (!m_downloads.contains(id)) {
+        return;
+    }
+    Download &download = m_downloads[id];
+    if (download.state != Queued && download.state != Running) {
+        return;
+    }
+    qDebug() << __PRETTY_FUNCTION__ << id;
+    stopDownload(download);
+    m_waiting.remove(id);
+    setState(download, Paused);
+    dispatch();
+}
+
+void OBSDownloadManager::resume(int id)
+{
+    if (!m_downloads.contains(id)) {
+        return;
+    }
+    Download &download = m_downloads[id];
+    if (download.state != Paused && download.state != Failed) {
+        return;
+    }
+    qDebug() << __PRETTY_FUNCTION__ << id;
+    download.attempts = 0;
+    download.errorString.clear();
+    setState(download, Queued);
+    dispatch();
+}
+
+void OBSDownloadManager::remove(int id)
+{
+    if (!m_downloads.contains(id)) {
+        return;
+    }
+    qDebug() << __PRETTY_FUNCTION__ << id;
+    Download &download = m_downloads[id];
+    stopDownload(download);
+    QFile::remove(partPath(download.path));
+    m_waiting.remove(id);
+    m_downloads.remove(id);
+    save();
+    dispatch();
+}
+
+bool OBSDownloadManager::contains(int id) const
+{
+    return m_downloads.contains(id);
+}
+
+OBSDownloadManager::Download OBSDownloadManager::getDownload(int id) const
+{
+    return m_downloads.value(id);
+}
+
+QList<int> OBSDownloadManager::getDownloadIds() const
+{
+    return m_downloads.keys();
+}
+
+int OBSDownloadManager::getMaxParallel() const
+{
+    return m_maxParallel;
+}
+
+void OBSDownloadManager::setMaxParallel(int maxParallel)
+{
+    m_maxParallel = qMax(1, maxParallel);
+    dispatch();
+}
+
+QString OBSDownloadManager::partPath(const QString &path)
+{
+    return path + ".part";
+}
+
+void OBSDownloadManager::dispatch()
+{
+    if (!m_authenticated) {
+        return;
+    }
+
+    int running = m_running.size();
+    for (auto it = m_downloads.begin(); it != m_downloads.end() && running < m_maxParallel; ++it) {
+        if (it->state == Queued && !m_waiting.contains(it->id)) {
+            startDownload(*it);
+            running++;
+        }
+    }
+}
+
+void OBSDownloadManager::startDownload(Download &download)
+{
+    QString part = partPath(download.path);
+    QDir().mkpath(QFileInfo(part).absolutePath());
+
+    if (m_obsCore->getBlobStore()->contains(download.md5)) {
+        qDebug() << __PRETTY_FUNCTION__ << download.id << "from the blob store";
+        setState(download, Verifying);
+        verify(download, true);
+        return;
+    }
+
+    qint64 offset = QFileInfo(part).size();
+    qDebug() << __PRETTY_FUNCTION__ << download.id << "from" << offset;
+
+    download.bytesReceived = offset;
+    m_running.insert(part, download.id);
+    m_handles.insert(download.id, m_obsCore->downloadFilePart(download.project, download.package,
+                                                              download.fileName, part, offset));
+    setState(download, Running);
+}
+
+void OBSDownloadManager::stopDownload(Download &download)
+{
+    if (download.state == Running) {
+        // The .part file is kept, the download resumes from it
+        m_obsCore->cancelRequest(m_handles.take(download.id));
+        m_running.remove(partPath(download.path));
+    }
+}
+
+void OBSDownloadManager::retryLater(Download &download)
+{
+    download.attempts++;
+    if (download.attempts > m_maxAttempts) {
+        fail(download, tr("Download interrupted too many times"));
+        return;
+    }
+
+    int delay = qMin(1000 * (1 << download.attempts), 60000);
+    qDebug() << __PRETTY_FUNCTION__ << download.id << "attempt" << download.attempts << "in" << delay << "ms";
+    int id = download.id;
+    m_waiting.insert(id);
+    setState(download, Queued);
+    QTimer::singleShot(delay, this, [this, id]() {
+        m_waiting.remove(id);
+        dispatch();
+    });
+}
+
+void OBSDownloadManager::verify(const Download &download, bool fromStore)
+{
+    int id = download.id;
+    QString part = partPath(download.path);
+    QString md5 = download.md5;
+    OBSBlobStore *blobStore = m_obsCore->getBlobStore();
+
+    QMetaObject::invokeMethod(m_verifier, [this, id, part, md5, fromStore, blobStore]() {
+        bool ok = true;
+        QString errorString;
+        if (fromStore && !blobStore->copyTo(md5, part)) {
+            // Fetched from the server on the next attempt
+            blobStore->remove(md5);
+        }
+        QFile file(part);
+        if (!file.open(QIODevice::ReadOnly)) {
+            ok = false;
+            errorString = file.errorString();
+        } else if (!md5.isEmpty()) {
+            QCryptographicHash hash(QCryptographicHash::Md5);
+            hash.addData(&file);
+            ok = (hash.result().toHex() == md5.toLatin1());
+            if (!ok) {
+                errorString = tr("Checksum mismatch");
+                if (fromStore) {
+                    blobStore->remove(md5);
+                }
+            } else if (!fromStore) {
+                blobStore->insertFile(md5, part);
+            }
+        }
+        QMetaObject::invokeMethod(this, [this, id, ok, errorString]() {
+            finishVerification(id, ok, errorString);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void OBSDownloadManager::finishVerification(int id, bool ok, const QString &errorString)
+{
+    if (!m_downloads.contains(id)) {
+        return;
+    }
+    Download &download = m_downloads[id];
+    QString part = partPath(download.path);
+
+    if (!ok) {
+        qDebug() << __PRETTY_FUNCTION__ << id << errorString;
+        // Start over, the file changed on the server or the parts don't fit
+        QFile::remove(part);
+        download.bytesReceived = 0;
+        if (download.attempts < m_maxAttempts) {
+            download.attempts++;
+            setState(download, Queued);
+            dispatch();
+        } else {
+            fail(download, errorString);
+        }
+        return;
+    }
+
+    QFile::remove(download.path);
+    if (!QFile::rename(part, download.path)) {
+        fail(download, tr("Cannot rename %1").arg(part));
+        return;
+    }
+
+    qDebug() << __PRETTY_FUNCTION__ << id << "saved to" << download.path;
+    setState(download, Finished);
+    emit downloadFinished(id);
+    m_downloads.remove(id);
+    save();
+}
+
+void OBSDownloadManager::fail(Download &download, const QString &errorString)
+{
+    qDebug() << __PRETTY_FUNCTION__ << download.id << errorString;
+    download.errorString = errorString;
+    setState(download, Failed);
+    emit downloadFailed(download.id, errorString);
+}
+
+void OBSDownloadManager::setState(Download &download, State state)
+{
+    download.state = state;
+    save();
+    emit downloadChanged(download.id);
+}
+
+void OBSDownloadManager::slotAuthenticated(bool authenticated)
+{
+    m_authenticated = authenticated;
+    dispatch();
+}
+
+void OBSDownloadManager::slotSessionReset()
+{
+    // The replies of the old session are gone without a word
+    m_handles.clear();
+    m_running.clear();
+    m_authenticated = false;
+    for (auto it = m_downloads.begin(); it != m_downloads.end(); ++it) {
+        if (it->state == Running) {
+            setState(*it, Queued);
+        }
+    }
+}
+
+void OBSDownloadManager::slotProgress(const QString &path, qint64 bytesReceived, qint64 bytesTotal)
+{
+    int id = m_running.value(path);
+    if (!id) {
+        return;
+    }
+    Download &download = m_downloads[id];
+    if (bytesReceived > download.bytesReceived) {
+        // It's moving, so it isn't stuck in a retry loop
+        download.attempts = 0;
+    }
+    download.bytesReceived = bytesReceived;
+    download.bytesTotal = bytesTotal;
+    emit downloadProgress(id, bytesReceived, bytesTotal);
+}
+
+void OBSDownloadManager::slotDownloaded(const QString &path)
+{
+    int id = m_running.take(path);
+    if (!id) {
+        return;
+    }
+    m_handles.remove(id);
+    Download &download = m_downloads[id];
+    setState(download, Verifying);
+    verify(download);
+    dispatch();
+}
+
+void OBSDownloadManager::slotFailed(const QString &path, const QString &errorString)
+{
+    int id = m_running.value(path);
+    if (!id) {
+        return;
+    }
+    Download &download = m_downloads[id];
+    // Also cancels the request if it's still running, e.g. after a write error
+    stopDownload(download);
+    fail(download, errorString);
+    dispatch();
+}
+
+void OBSDownloadManager::slotInterrupted(const QString &path)
+{
+    int id = m_running.take(path);
+    if (!id) {
+        return;
+    }
+    m_handles.remove(id);
+    retryLater(m_downloads[id]);
+    dispatch();
+}
+
+void OBSDownloadManager::load()
+{
+    QFile file(m_queueFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    quint32 version;
+    stream >> version;
+    if (version != queueFormatVersion) {
+        qDebug() << __PRETTY_FUNCTION__ << "Discarding queue with version" << version;
+        return;
+    }
+
+    int count;
+    stream >> m_nextId >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        Download download;
+        int state;
+        stream >> download.id >> download.project >> download.package >> download.fileName
+               >> download.path >> download.md5 >> state >> download.bytesTotal >> download.errorString;
+        // Interrupted by the end of the last run
+        download.state = (state == Running || state == Verifying) ? Queued : State(state);
+        download.bytesReceived = QFileInfo(partPath(download.path)).size();
+        m_downloads.insert(download.id, download);
+    }
+    qDebug() << __PRETTY_FUNCTION__ << m_downloads.size() << "downloads restored";
+}
+
+void OBSDownloadManager::save() const
+{
+    QSaveFile file(m_queueFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << __PRETTY_FUNCTION__ << "Cannot open" << m_queueFileName << file.errorString();
+        return;
+    }
+    QDataStream stream(&file);
+    stream << queueFormatVersion << m_nextId << m_downloads.size();
+    for (const Download &download : m_downloads) {
+        stream << download.id << download.project << download.package << download.fileName
+               << download.path << download.md5 << int(download.state) << download.bytesTotal
+               << download.errorString;
+    }
+    if (!file.commit()) {
+        qDebug() << __PRETTY_FUNCTION__ << "Cannot write" << m_queueFileName << file.errorString();
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSDOWNLOADMANAGER_H
+#define OBSDOWNLOADMANAGER_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QThread>
+#include "obscore.h"
+#include "obsrequesthandle.h"
+
+/*
+ * OBSDownloadManager keeps a queue of source file downloads, which is saved
+ * to disk and restored on the next run. At most getMaxParallel() of them run
+ * at the same time.
+ *
+ * A download is written to <path>.part. When the connection drops, it's
+ * retried with a backoff and continues where it stopped, with a Range
+ * request. Paused downloads keep their .part file too. Once complete, the
+ * file is checked against the md5 of the directory listing, if known, on a
+ * worker thread and renamed to its path. Verified files are added to the
+ * OBSBlobStore, and a download whose md5 is already there is copied from
+ * it instead of being fetched.
+ *
+ */
+class OBSDownloadManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Queued,
+        Running,
+        Paused,
+        Verifying,
+        Finished,
+        Failed
+    };
+
+    struct Download {
+        Download() : id(0), state(Queued), bytesReceived(0), bytesTotal(-1), attempts(0) {}
+        int id;
+        QString project;
+        QString package;
+        QString fileName;
+        QString path;
+        QString md5;
+        State state;
+        qint64 bytesReceived;
+        qint64 bytesTotal;
+        int attempts;
+        QString errorString;
+    };
+
+    explicit OBSDownloadManager(QObject *parent = nullptr);
+    ~OBSDownloadManager();
+    int enqueue(const QString &project, const QString &package, const QString &fileName,
+                const QString &path, const QString &md5 = QString());
+    void pause(int id);
+    void resume(int id);
+    void remove(int id);
+    bool contains(int id) const;
+    Download getDownload(int id) const;
+    QList<int> getDownloadIds() const;
+    int getMaxParallel() const;
+    void setMaxParallel(int maxParallel);
+    static QString partPath(const QString &path);
+
+signals:
+    void downloadChanged(int id);
+    void downloadProgress(int id, qint64 bytesReceived, qint64 bytesTotal);
+    void downloadFinished(int id);
+    void downloadFailed(int id, const QString &errorString);
+
+private:
+    OBSCore *m_obsCore;
+    QMap<int, Download> m_downloads; // in queue order
+    QHash<int, OBSRequestHandle> m_handles;
+    QHash<QString, int> m_running; // .part path -> id
+    QSet<int> m_waiting; // queued, but waiting to be retried
+    int m_nextId;
+    int m_maxParallel;
+    int m_maxAttempts;
+    bool m_authenticated;
+    QString m_queueFileName;
+    QThread *m_verifierThread;
+    QObject *m_verifier;
+    void dispatch();
+    void startDownload(Download &download);
+    void stopDownload(Download &download);
+    void retryLater(Download &download);
+    void verify(const Download &download, bool fromStore = false);
+    void finishVerification(int id, bool ok, const QString &errorString);
+    void fail(Download &download, const QString &errorString);
+    void setState(Download &download, State state);
+    void load();
+    void save() const;
+
+private slots:
+    void slotAuthenticated(bool authenticated);
+    void slotSessionReset();
+    void slotProgress(const QString &path, qint64 bytesReceived, qint64 bytesTotal);
+    void slotDownloaded(const QString &path);
+    void slotFailed(const QString &path, const QString &errorString);
+    void slotInterrupted(const QString &path);
+};
+
+#endif // OBSDOWNLOADMANAGER_H
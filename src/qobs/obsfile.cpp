@@ -54,3 +54,13 @@ void OBSFile::setLastModified(const QString &value)
 {
     lastModified = value;
 }
+
+QString OBSFile::getMd5() const
+{
+    return md5;
+}
+
+void OBSFile::setMd5(const QString &value)
+{
+    md5 = value;
+}
@@ -22,6 +22,7 @@
 #define OBSFILE_H
 
 #include <QString>
+#include <QMetaType>
 #include "obsobject.h"
 
 class OBSFile : public OBSObject
@@ -38,10 +39,16 @@ public:
     QString getLastModified() const;
     void setLastModified(const QString &value);
 
+    QString getMd5() const;
+    void setMd5(const QString &value);
+
 private:
     QString name;
     QString size;
     QString lastModified;
+    QString md5;
 };
 
+Q_DECLARE_METATYPE(OBSFile)
+
 #endif // OBSFILE_H
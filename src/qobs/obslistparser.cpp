@@ -0,0 +1,77 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obslistparser.h"
+#include <QDebug>
+
+OBSListParser::OBSListParser(const QString &userHome) :
+    m_userHome(userHome)
+{
+}
+
+QStringList OBSListParser::addData(const QByteArray &data)
+{
+    QStringList entries;
+    m_xml.addData(data);
+
+    while (!m_xml.atEnd()) {
+        m_xml.readNext();
+
+        if (m_xml.isStartElement() && (m_xml.name()=="entry" || m_xml.name()=="repository")) {
+            QXmlStreamAttributes attrib = m_xml.attributes();
+
+            if (attrib.value("code") == "unregistered_ichain_user") {
+                qDebug() << "Unregistered username!";
+            } else {
+                QString entry = attrib.value("name").toString();
+                if (isAccepted(entry)) {
+                    entries.append(entry);
+                }
+            }
+        }
+    }
+
+    // Running out of data just means the rest hasn't arrived yet
+    if (m_xml.hasError() && m_xml.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+        qDebug() << "Error parsing XML!" << m_xml.errorString();
+    }
+
+    m_list.append(entries);
+    return entries;
+}
+
+QStringList OBSListParser::getList() const
+{
+    return m_list;
+}
+
+void OBSListParser::clear()
+{
+    m_xml.clear();
+    m_list.clear();
+}
+
+bool OBSListParser::isAccepted(const QString &entry) const
+{
+    if (m_userHome.isEmpty()) {
+        return true;
+    }
+    return entry.startsWith(m_userHome) || !entry.startsWith("home");
+}
@@ -0,0 +1,49 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSLISTPARSER_H
+#define OBSLISTPARSER_H
+
+#include <QXmlStreamReader>
+#include <QStringList>
+
+/*
+ * OBSListParser parses <directory> listings (entry/repository names)
+ * incrementally, so that the entries can be used as the reply arrives.
+ * If userHome is set, home projects other than userHome are skipped.
+ *
+ */
+class OBSListParser
+{
+
+public:
+    explicit OBSListParser(const QString &userHome = QString());
+    QStringList addData(const QByteArray &data);
+    QStringList getList() const;
+    void clear();
+
+private:
+    QXmlStreamReader m_xml;
+    QString m_userHome;
+    QStringList m_list;
+    bool isAccepted(const QString &entry) const;
+};
+
+#endif // OBSLISTPARSER_H
@@ -0,0 +1,44 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obsmd5task.h"
+#include <QFile>
+#include <QCryptographicHash>
+
+OBSMd5Task::OBSMd5Task(const QString &path, const Callback &callback) :
+    m_path(path),
+    m_callback(callback)
+{
+}
+
+void OBSMd5Task::run()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_callback(QString(), file.errorString());
+        return;
+    }
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (!hash.addData(&file)) {
+        m_callback(QString(), file.errorString());
+        return;
+    }
+    m_callback(QString::fromLatin1(hash.result().toHex()), QString());
+}
@@ -0,0 +1,46 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSMD5TASK_H
+#define OBSMD5TASK_H
+
+#include <QRunnable>
+#include <QString>
+#include <functional>
+
+/*
+ * OBSMd5Task hashes a file on a QThreadPool. The callback is called on the
+ * pool's thread, with either the md5 or an error string.
+ *
+ */
+class OBSMd5Task : public QRunnable
+{
+
+public:
+    typedef std::function<void(const QString &md5, const QString &errorString)> Callback;
+    OBSMd5Task(const QString &path, const Callback &callback);
+    void run() override;
+
+private:
+    QString m_path;
+    Callback m_callback;
+};
+
+#endif // OBSMD5TASK_H
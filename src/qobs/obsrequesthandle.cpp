@@ -0,0 +1,98 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obsrequesthandle.h"
+#include <QMutex>
+
+static QAtomicInteger<quint64> lastId(0);
+// Serializes joining and cancelling, which can happen in different threads
+static QMutex waitersMutex;
+
+OBSRequestHandle::OBSRequestHandle()
+{
+
+}
+
+OBSRequestHandle OBSRequestHandle::create()
+{
+    OBSRequestHandle handle;
+    handle.m_state.reset(new State());
+    handle.m_state->id = ++lastId;
+    handle.m_state->cancelled.store(0);
+    handle.m_state->waiters.store(1);
+    return handle;
+}
+
+bool OBSRequestHandle::isNull() const
+{
+    return m_state.isNull();
+}
+
+bool OBSRequestHandle::isCancelled() const
+{
+    return m_state && m_state->waiters.load() == 0;
+}
+
+void OBSRequestHandle::cancel()
+{
+    QMutexLocker locker(&waitersMutex);
+    if (!m_state || m_state->cancelled.load()) {
+        return;
+    }
+    m_state->cancelled.store(1);
+    State *request = m_state->joined ? m_state->joined.data() : m_state.data();
+    request->waiters.deref();
+}
+
+void OBSRequestHandle::join(const OBSRequestHandle &request)
+{
+    QMutexLocker locker(&waitersMutex);
+    if (!m_state || request.isNull() || m_state->joined) {
+        return;
+    }
+    m_state->joined = request.m_state;
+    // Cancelled before joining, it doesn't wait for anything
+    if (!m_state->cancelled.load()) {
+        request.m_state->waiters.ref();
+    }
+}
+
+void OBSRequestHandle::retain()
+{
+    QMutexLocker locker(&waitersMutex);
+    if (m_state) {
+        m_state->waiters.ref();
+    }
+}
+
+quint64 OBSRequestHandle::getId() const
+{
+    return m_state ? m_state->id : 0;
+}
+
+bool OBSRequestHandle::operator==(const OBSRequestHandle &other) const
+{
+    return m_state == other.m_state;
+}
+
+bool OBSRequestHandle::operator!=(const OBSRequestHandle &other) const
+{
+    return m_state != other.m_state;
+}
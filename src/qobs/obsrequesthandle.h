@@ -0,0 +1,66 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSREQUESTHANDLE_H
+#define OBSREQUESTHANDLE_H
+
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QMetaType>
+
+/*
+ * OBSRequestHandle identifies a request that can be cancelled with
+ * OBS::cancelRequest(). Copies share the same state, and cancelled() can be
+ * checked from any thread, so a superseded reply is dropped before it is
+ * parsed. A default constructed handle is null and never cancelled.
+ *
+ * Identical requests share one reply: the handle of a later one joins the
+ * handle of the request in flight, which is only cancelled once every handle
+ * waiting for it has been cancelled. retain() adds a waiter that never
+ * cancels.
+ *
+ */
+class OBSRequestHandle
+{
+public:
+    OBSRequestHandle();
+    static OBSRequestHandle create();
+    bool isNull() const;
+    bool isCancelled() const;
+    void cancel();
+    void join(const OBSRequestHandle &request);
+    void retain();
+    quint64 getId() const;
+    bool operator==(const OBSRequestHandle &other) const;
+    bool operator!=(const OBSRequestHandle &other) const;
+
+private:
+    struct State {
+        quint64 id;
+        QAtomicInt cancelled; // given up by its caller
+        QAtomicInt waiters; // handles still waiting for this request
+        QSharedPointer<State> joined; // request waited for, if not this one
+    };
+    QSharedPointer<State> m_state;
+};
+
+Q_DECLARE_METATYPE(OBSRequestHandle)
+
+#endif // OBSREQUESTHANDLE_H
@@ -0,0 +1,269 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obsrequestscheduler.h"
+#include <QDebug>
+#include <QtMath>
+
+OBSRequestScheduler::OBSRequestScheduler(QObject *parent) : QObject(parent),
+    m_inFlight(0),
+    m_maxInFlight(6),
+    m_rate(20.0),
+    m_burst(20),
+    m_tokens(20.0),
+    m_dispatchTimer(new QTimer(this)),
+    m_lastWaitTime(0),
+    m_totalWaitTime(0),
+    m_maxWaitTime(0),
+    m_dispatched(0),
+    m_burstRequests(0),
+    m_burstPeakInFlight(0),
+    m_burstInFlightTime(0),
+    m_burstMaxWaitTime(0)
+{
+    for (int i = 0; i < priorityCount; ++i) {
+        m_paused[i] = false;
+    }
+    m_dispatchTimer->setSingleShot(true);
+    connect(m_dispatchTimer, &QTimer::timeout, this, &OBSRequestScheduler::dispatch);
+    m_lastRefill.start();
+}
+
+void OBSRequestScheduler::enqueue(const SendFunction &send, Priority priority)
+{
+    PendingRequest pendingRequest;
+    pendingRequest.send = send;
+    pendingRequest.queued.start();
+    m_queues[priority].enqueue(pendingRequest);
+    emit queueDepthChanged(getQueueDepth());
+
+    dispatch();
+}
+
+void OBSRequestScheduler::clear()
+{
+    qDebug() << __PRETTY_FUNCTION__ << "Dropping" << getQueueDepth() << "queued requests";
+    for (int i = 0; i < priorityCount; ++i) {
+        m_queues[i].clear();
+    }
+    // Replies in flight keep their slot until they finish, as QNAM is kept
+    m_dispatchTimer->stop();
+    m_burstTimer.invalidate();
+    emit queueDepthChanged(0);
+}
+
+int OBSRequestScheduler::getMaxInFlight() const
+{
+    return m_maxInFlight;
+}
+
+void OBSRequestScheduler::setMaxInFlight(int maxInFlight)
+{
+    m_maxInFlight = qMax(1, maxInFlight);
+    dispatch();
+}
+
+double OBSRequestScheduler::getRate() const
+{
+    return m_rate;
+}
+
+int OBSRequestScheduler::getBurst() const
+{
+    return m_burst;
+}
+
+void OBSRequestScheduler::setRateLimit(double rate, int burst)
+{
+    m_rate = qMax(0.0, rate);
+    m_burst = qMax(1, burst);
+    m_tokens = qMin(m_tokens, double(m_burst));
+    dispatch();
+}
+
+int OBSRequestScheduler::getInFlight() const
+{
+    return m_inFlight;
+}
+
+int OBSRequestScheduler::getQueueDepth() const
+{
+    int queueDepth = 0;
+    for (int i = 0; i < priorityCount; ++i) {
+        queueDepth += m_queues[i].size();
+    }
+    return queueDepth;
+}
+
+int OBSRequestScheduler::getQueueDepth(Priority priority) const
+{
+    return m_queues[priority].size();
+}
+
+qint64 OBSRequestScheduler::getLastWaitTime() const
+{
+    return m_lastWaitTime;
+}
+
+qint64 OBSRequestScheduler::getAverageWaitTime() const
+{
+    return m_dispatched > 0 ? m_totalWaitTime / m_dispatched : 0;
+}
+
+qint64 OBSRequestScheduler::getMaxWaitTime() const
+{
+    return m_maxWaitTime;
+}
+
+bool OBSRequestScheduler::isPaused(Priority priority) const
+{
+    return m_paused[priority];
+}
+
+void OBSRequestScheduler::setPaused(Priority priority, bool paused)
+{
+    if (m_paused[priority] == paused) {
+        return;
+    }
+    qDebug() << __PRETTY_FUNCTION__ << priority << paused;
+    m_paused[priority] = paused;
+    dispatch();
+}
+
+bool OBSRequestScheduler::hasDispatchableRequests() const
+{
+    for (int i = 0; i < priorityCount; ++i) {
+        if (!m_paused[i] && !m_queues[i].isEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void OBSRequestScheduler::refillTokens()
+{
+    qint64 elapsed = m_lastRefill.restart();
+    m_tokens = qMin(double(m_burst), m_tokens + elapsed * m_rate / 1000.0);
+}
+
+bool OBSRequestScheduler::takeToken()
+{
+    if (m_rate <= 0.0) {
+        return true;
+    }
+
+    refillTokens();
+    if (m_tokens >= 1.0) {
+        m_tokens -= 1.0;
+        return true;
+    }
+    return false;
+}
+
+OBSRequestScheduler::PendingRequest OBSRequestScheduler::takeNext()
+{
+    for (int i = 0; i < priorityCount; ++i) {
+        if (!m_paused[i] && !m_queues[i].isEmpty()) {
+            return m_queues[i].dequeue();
+        }
+    }
+    return PendingRequest();
+}
+
+void OBSRequestScheduler::dispatch()
+{
+    while (m_inFlight < m_maxInFlight && hasDispatchableRequests()) {
+        if (!takeToken()) {
+            if (!m_dispatchTimer->isActive()) {
+                int msec = qCeil((1.0 - m_tokens) * 1000.0 / m_rate);
+                m_dispatchTimer->start(qMax(1, msec));
+            }
+            return;
+        }
+
+        PendingRequest pendingRequest = takeNext();
+        m_lastWaitTime = pendingRequest.queued.elapsed();
+        m_totalWaitTime += m_lastWaitTime;
+        m_maxWaitTime = qMax(m_maxWaitTime, m_lastWaitTime);
+        m_dispatched++;
+
+        QNetworkReply *reply = pendingRequest.send();
+        if (reply) {
+            if (!m_burstTimer.isValid()) {
+                m_burstTimer.start();
+                m_inFlightChanged.start();
+                m_burstRequests = 0;
+                m_burstPeakInFlight = 0;
+                m_burstInFlightTime = 0;
+                m_burstMaxWaitTime = 0;
+            }
+            accumulateInFlight();
+            m_inFlight++;
+            m_replies.insert(reply);
+            m_burstRequests++;
+            m_burstPeakInFlight = qMax(m_burstPeakInFlight, m_inFlight);
+            m_burstMaxWaitTime = qMax(m_burstMaxWaitTime, m_lastWaitTime);
+            // A reply deleted with its manager never finishes
+            connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+                slotReplyFinished(reply);
+            });
+            connect(reply, &QObject::destroyed, this, [this, reply]() {
+                slotReplyFinished(reply);
+            });
+        }
+        qDebug() << __PRETTY_FUNCTION__ << "Waited" << m_lastWaitTime << "ms,"
+                 << "in flight:" << m_inFlight << "queued:" << getQueueDepth();
+        emit queueDepthChanged(getQueueDepth());
+    }
+}
+
+void OBSRequestScheduler::slotReplyFinished(QNetworkReply *reply)
+{
+    // Only counted once, whether it finished or was deleted first
+    if (!m_replies.remove(reply)) {
+        return;
+    }
+    accumulateInFlight();
+    m_inFlight--;
+    dispatch();
+
+    if (m_inFlight == 0 && !hasDispatchableRequests() && m_burstTimer.isValid()) {
+        finishBurst();
+    }
+}
+
+void OBSRequestScheduler::accumulateInFlight()
+{
+    if (m_burstTimer.isValid()) {
+        m_burstInFlightTime += m_inFlight * m_inFlightChanged.restart();
+    }
+}
+
+void OBSRequestScheduler::finishBurst()
+{
+    qint64 elapsed = m_burstTimer.elapsed();
+    double averageInFlight = elapsed > 0 ? double(m_burstInFlightTime) / elapsed : m_burstPeakInFlight;
+    m_burstTimer.invalidate();
+
+    qDebug() << __PRETTY_FUNCTION__ << m_burstRequests << "requests in" << elapsed << "ms,"
+             << "peak in flight:" << m_burstPeakInFlight << "average:" << averageInFlight
+             << "max queue wait:" << m_burstMaxWaitTime << "ms";
+    emit burstFinished(m_burstRequests, elapsed, m_burstPeakInFlight, averageInFlight, m_burstMaxWaitTime);
+}
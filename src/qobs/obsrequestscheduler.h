@@ -0,0 +1,116 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSREQUESTSCHEDULER_H
+#define OBSREQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QNetworkReply>
+#include <functional>
+
+/*
+ * OBSRequestScheduler queues requests and sends them with a bounded number
+ * of requests in flight and a token bucket rate limit. Interactive requests
+ * are always sent before normal and background ones, so a click in the
+ * browser doesn't wait behind a monitor refresh burst. A paused priority
+ * keeps its requests queued until it is resumed.
+ *
+ * A burst lasts from the first request sent while idle until nothing is in
+ * flight or dispatchable. Its duration, the concurrency achieved and the
+ * longest queue wait are reported with burstFinished().
+ *
+ */
+class OBSRequestScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Interactive,
+        Normal,
+        Background
+    };
+    typedef std::function<QNetworkReply *()> SendFunction;
+
+    explicit OBSRequestScheduler(QObject *parent = nullptr);
+    void enqueue(const SendFunction &send, Priority priority = Normal);
+    void clear();
+    int getMaxInFlight() const;
+    void setMaxInFlight(int maxInFlight);
+    double getRate() const;
+    int getBurst() const;
+    void setRateLimit(double rate, int burst);
+    int getInFlight() const;
+    int getQueueDepth() const;
+    int getQueueDepth(Priority priority) const;
+    qint64 getLastWaitTime() const;
+    qint64 getAverageWaitTime() const;
+    qint64 getMaxWaitTime() const;
+    bool isPaused(Priority priority) const;
+    void setPaused(Priority priority, bool paused);
+
+signals:
+    void queueDepthChanged(int queueDepth);
+    void burstFinished(int requests, qint64 elapsed, int peakInFlight,
+                       double averageInFlight, qint64 maxWaitTime);
+
+private:
+    struct PendingRequest {
+        SendFunction send;
+        QElapsedTimer queued;
+    };
+    static const int priorityCount = Background + 1;
+    QQueue<PendingRequest> m_queues[priorityCount];
+    bool m_paused[priorityCount];
+    int m_inFlight;
+    QSet<QNetworkReply *> m_replies; // sent by the scheduler and not finished yet
+    int m_maxInFlight;
+    double m_rate; // tokens per second, 0 disables the rate limit
+    int m_burst;
+    double m_tokens;
+    QElapsedTimer m_lastRefill;
+    QTimer *m_dispatchTimer;
+    qint64 m_lastWaitTime;
+    qint64 m_totalWaitTime;
+    qint64 m_maxWaitTime;
+    qint64 m_dispatched;
+    QElapsedTimer m_burstTimer;
+    QElapsedTimer m_inFlightChanged;
+    int m_burstRequests;
+    int m_burstPeakInFlight;
+    qint64 m_burstInFlightTime; // sum of in flight requests * msec
+    qint64 m_burstMaxWaitTime;
+    void accumulateInFlight();
+    void finishBurst();
+    void refillTokens();
+    bool takeToken();
+    bool hasDispatchableRequests() const;
+    PendingRequest takeNext();
+
+private slots:
+    void dispatch();
+    void slotReplyFinished(QNetworkReply *reply);
+};
+
+#endif // OBSREQUESTSCHEDULER_H
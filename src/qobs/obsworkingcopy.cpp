@@ -0,0 +1,589 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "obsworkingcopy.h"
+#include "obsmd5task.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QPointer>
+#include <QThreadPool>
+#include <QCoreApplication>
+
+static const quint32 stateFormatVersion = 1;
+static const QString stateDirectory = ".qactus";
+
+// Runs a function on a QThreadPool thread
+class OBSFunctionTask : public QRunnable
+{
+public:
+    explicit OBSFunctionTask(const std::function<void()> &function) :
+        m_function(function) {}
+
+    void run() override
+    {
+        m_function();
+    }
+
+private:
+    std::function<void()> m_function;
+};
+
+OBSWorkingCopy::OBSWorkingCopy(const QString &directory, QObject *parent) : QObject(parent),
+    m_obsCore(OBSCore::getInstance()),
+    m_directory(directory),
+    m_operation(None),
+    m_generation(0),
+    m_pendingHashes(0),
+    m_listed(false),
+    m_pendingFetches(0),
+    m_fetched(0),
+    m_deleted(0),
+    m_outdated(false)
+{
+    if (isWorkingCopy(m_directory)) {
+        load();
+    }
+
+    connect(m_obsCore, &OBSCore::fileMd5ListFetched, this, &OBSWorkingCopy::slotFileMd5ListFetched);
+    connect(m_obsCore, &OBSCore::fileMd5ListFailed, this, &OBSWorkingCopy::slotFileMd5ListFailed);
+    connect(m_obsCore, &OBSCore::fileDownloaded, this, &OBSWorkingCopy::slotFileDownloaded);
+    connect(m_obsCore, &OBSCore::fileDownloadFailed, this, &OBSWorkingCopy::slotFileDownloadFailed);
+    connect(m_obsCore, &OBSCore::filesCommitted, this, &OBSWorkingCopy::slotFilesCommitted);
+    connect(m_obsCore, &OBSCore::commitFailed, this, &OBSWorkingCopy::slotCommitFailed);
+    connect(m_obsCore, &OBSCore::nothingToCommit, this, &OBSWorkingCopy::slotNothingToCommit);
+}
+
+bool OBSWorkingCopy::isWorkingCopy(const QString &directory)
+{
+    return QFileInfo::exists(QDir(directory).filePath(stateDirectory + "/files"));
+}
+
+QString OBSWorkingCopy::getDirectory() const
+{
+    return m_directory;
+}
+
+QString OBSWorkingCopy::getProject() const
+{
+    return m_project;
+}
+
+QString OBSWorkingCopy::getPackage() const
+{
+    return m_package;
+}
+
+QString OBSWorkingCopy::getSrcmd5() const
+{
+    return m_srcmd5;
+}
+
+OBSWorkingCopy::Operation OBSWorkingCopy::getOperation() const
+{
+    return m_operation;
+}
+
+bool OBSWorkingCopy::checkout(const QString &project, const QString &package)
+{
+    if (isWorkingCopy(m_directory)) {
+        emit failed(tr("%1 is already a working copy").arg(m_directory));
+        return false;
+    }
+    if (!QDir().mkpath(QDir(m_directory).filePath(stateDirectory))) {
+        emit failed(tr("Cannot create directory %1").arg(m_directory));
+        return false;
+    }
+    if (!start(Checkout)) {
+        return false;
+    }
+
+    m_project = project;
+    m_package = package;
+    m_srcmd5.clear();
+    m_base.clear();
+    // From now on it's a working copy, even if the checkout is interrupted
+    if (!save()) {
+        fail(tr("Cannot write %1").arg(stateFileName()));
+        return false;
+    }
+
+    qDebug() << __PRETTY_FUNCTION__ << project << package << "->" << m_directory;
+    emit progress(tr("Checking out %1/%2...").arg(project, package));
+    startUpdate();
+    return true;
+}
+
+bool OBSWorkingCopy::update()
+{
+    if (m_project.isEmpty()) {
+        emit failed(tr("%1 is not a working copy").arg(m_directory));
+        return false;
+    }
+    if (!start(Update)) {
+        return false;
+    }
+
+    qDebug() << __PRETTY_FUNCTION__ << m_directory;
+    emit progress(tr("Updating %1/%2...").arg(m_project, m_package));
+    startUpdate();
+    return true;
+}
+
+bool OBSWorkingCopy::commit(const QString &comment)
+{
+    if (m_project.isEmpty()) {
+        emit failed(tr("%1 is not a working copy").arg(m_directory));
+        return false;
+    }
+    if (!start(Commit)) {
+        return false;
+    }
+
+    // Only tracked files are committed, removing them isn't supported
+    QStringList tracked;
+    for (auto it = m_base.constBegin(); it != m_base.constEnd(); ++it) {
+        if (QFileInfo::exists(filePath(it.key()))) {
+            tracked.append(it.key());
+        }
+    }
+    if (tracked.isEmpty()) {
+        fail(tr("No changes to commit"));
+        return false;
+    }
+
+    qDebug() << __PRETTY_FUNCTION__ << m_directory;
+    m_comment = comment;
+    emit progress(tr("Hashing %1 files...").arg(tracked.size()));
+    // The listing tells whether the files changed on the server since the last update
+    m_request = m_obsCore->getFileMd5List(m_project, m_package);
+    hashFiles(tracked);
+    return true;
+}
+
+void OBSWorkingCopy::cancel()
+{
+    if (m_operation == None) {
+        return;
+    }
+    qDebug() << __PRETTY_FUNCTION__ << m_directory;
+    fail(tr("Cancelled"));
+}
+
+QString OBSWorkingCopy::filePath(const QString &name) const
+{
+    return QDir(m_directory).filePath(name);
+}
+
+QString OBSWorkingCopy::stateFileName() const
+{
+    return QDir(m_directory).filePath(stateDirectory + "/files");
+}
+
+bool OBSWorkingCopy::load()
+{
+    QFile file(stateFileName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << __PRETTY_FUNCTION__ << "Cannot open" << file.fileName() << file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 version;
+    stream >> version;
+    if (version != stateFormatVersion) {
+        qDebug() << __PRETTY_FUNCTION__ << "Unknown version" << version;
+        return false;
+    }
+    stream >> m_project >> m_package >> m_srcmd5 >> m_base;
+    return stream.status() == QDataStream::Ok;
+}
+
+bool OBSWorkingCopy::save()
+{
+    QSaveFile file(stateFileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << __PRETTY_FUNCTION__ << "Cannot open" << file.fileName() << file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    stream << stateFormatVersion << m_project << m_package << m_srcmd5 << m_base;
+    return file.commit();
+}
+
+bool OBSWorkingCopy::start(Operation operation)
+{
+    if (m_operation != None) {
+        qDebug() << __PRETTY_FUNCTION__ << "Busy with operation" << m_operation;
+        return false;
+    }
+    m_operation = operation;
+    m_generation++;
+    m_request = OBSRequestHandle();
+    m_downloads.clear();
+    m_localMd5s.clear();
+    m_remoteMd5s.clear();
+    m_remoteSrcmd5.clear();
+    m_pendingHashes = 0;
+    m_listed = false;
+    m_fetching.clear();
+    m_pendingFetches = 0;
+    m_fetched = 0;
+    m_deleted = 0;
+    m_outdated = false;
+    m_conflicts.clear();
+    m_committed.clear();
+    return true;
+}
+
+void OBSWorkingCopy::startUpdate()
+{
+    // The listing and the hashes of the local files are fetched at the same time
+    m_request = m_obsCore->getFileMd5List(m_project, m_package);
+    hashFiles(QDir(m_directory).entryList(QDir::Files));
+}
+
+void OBSWorkingCopy::hashFiles(const QStringList &names)
+{
+    m_pendingHashes = names.size();
+    QPointer<OBSWorkingCopy> self(this);
+    int generation = m_generation;
+
+    for (const QString &name : names) {
+        QThreadPool::globalInstance()->start(new OBSMd5Task(filePath(name), [self, generation, name](const QString &md5,
+                                                                                                   const QString &errorString) {
+            // Through the application object, this one may be gone by then
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [self, generation, name, md5, errorString]() {
+                if (self && self->m_generation == generation) {
+                    self->fileHashed(name, md5, errorString);
+                }
+            }, Qt::QueuedConnection);
+        }));
+    }
+}
+
+void OBSWorkingCopy::fileHashed(const QString &name, const QString &md5, const QString &errorString)
+{
+    if (!errorString.isEmpty()) {
+        fail(QString("%1: %2").arg(name, errorString));
+        return;
+    }
+    m_localMd5s.insert(name, md5);
+    if (--m_pendingHashes > 0) {
+        return;
+    }
+
+    if (!m_listed) {
+        return;
+    }
+    if (m_operation == Commit) {
+        sendCommit();
+    } else {
+        applyUpdate();
+    }
+}
+
+void OBSWorkingCopy::slotFileMd5ListFetched(const QString &project, const QString &package, const QString &srcmd5,
+                                            const QHash<QString, QString> &files)
+{
+    if (m_operation == None || m_listed || project != m_project || package != m_package) {
+        return;
+    }
+    m_remoteMd5s = files;
+    m_remoteSrcmd5 = srcmd5;
+    m_listed = true;
+    if (m_pendingHashes > 0) {
+        return;
+    }
+    if (m_operation == Commit) {
+        sendCommit();
+    } else {
+        applyUpdate();
+    }
+}
+
+void OBSWorkingCopy::slotFileMd5ListFailed(const QString &project, const QString &package, const QString &errorString)
+{
+    if (m_operation == None || m_listed || project != m_project || package != m_package) {
+        return;
+    }
+    fail(errorString);
+}
+
+void OBSWorkingCopy::applyUpdate()
+{
+    // Files changed locally keep their old base md5, so they still show
+    // up as changed. They are conflicts if they changed on the server too
+    QHash<QString, QString> base;
+    QHash<QString, QString> toFetch;
+
+    for (auto it = m_remoteMd5s.constBegin(); it != m_remoteMd5s.constEnd(); ++it) {
+        const QString &name = it.key();
+        const QString &remote = it.value();
+        bool present = m_localMd5s.contains(name);
+        QString local = m_localMd5s.value(name);
+
+        if (present && local == remote) {
+            base.insert(name, remote);
+            continue;
+        }
+        if (m_base.contains(name)) {
+            base.insert(name, m_base.value(name));
+        }
+        if (!present || (m_base.contains(name) && local == m_base.value(name))) {
+            toFetch.insert(name, remote);
+        } else if (!m_base.contains(name) || remote != m_base.value(name)) {
+            m_conflicts.append(name);
+        }
+    }
+
+    for (auto it = m_base.constBegin(); it != m_base.constEnd(); ++it) {
+        const QString &name = it.key();
+        if (m_remoteMd5s.contains(name) || !m_localMd5s.contains(name)) {
+            continue;
+        }
+        if (m_localMd5s.value(name) == it.value()) {
+            // Removed on the server and untouched here
+            QFile::remove(filePath(name));
+            m_deleted++;
+        } else {
+            // Changed here, it's kept as an untracked file
+            m_conflicts.append(name);
+        }
+    }
+    m_base = base;
+
+    qDebug() << __PRETTY_FUNCTION__ << toFetch.size() << "to fetch," << m_deleted << "removed,"
+             << m_conflicts.size() << "conflicts";
+    if (toFetch.isEmpty()) {
+        finishUpdate();
+        return;
+    }
+
+    emit progress(tr("Fetching %1 files...").arg(toFetch.size()));
+    m_pendingFetches = toFetch.size();
+    for (auto it = toFetch.constBegin(); it != toFetch.constEnd(); ++it) {
+        fetchFile(it.key(), it.value());
+    }
+}
+
+void OBSWorkingCopy::fetchFile(const QString &name, const QString &md5)
+{
+    OBSBlobStore *blobStore = m_obsCore->getBlobStore();
+    if (!blobStore->contains(md5)) {
+        downloadFile(name);
+        return;
+    }
+
+    QString path = filePath(name);
+    QPointer<OBSWorkingCopy> self(this);
+    int generation = m_generation;
+    QThreadPool::globalInstance()->start(new OBSFunctionTask([self, generation, blobStore, name, md5, path]() {
+        bool ok = blobStore->copyTo(md5, path);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, generation, name, md5, ok]() {
+            if (!self || self->m_generation != generation) {
+                return;
+            }
+            if (ok) {
+                self->fileFetched(name, md5, QString());
+            } else {
+                self->downloadFile(name);
+            }
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void OBSWorkingCopy::downloadFile(const QString &name)
+{
+    QString path = filePath(name);
+    m_fetching.insert(path, name);
+    m_downloads.append(m_obsCore->downloadFile(m_project, m_package, name, path));
+}
+
+void OBSWorkingCopy::slotFileDownloaded(const QString &path)
+{
+    if (!m_fetching.contains(path)) {
+        return;
+    }
+    QString name = m_fetching.take(path);
+    QString expected = m_remoteMd5s.value(name);
+    OBSBlobStore *blobStore = m_obsCore->getBlobStore();
+    QPointer<OBSWorkingCopy> self(this);
+    int generation = m_generation;
+
+    QThreadPool::globalInstance()->start(new OBSMd5Task(path, [self, generation, blobStore, name, expected, path](
+                                                        const QString &md5, const QString &errorString) {
+        if (md5 == expected) {
+            blobStore->insertFile(md5, path);
+        }
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [self, generation, name, md5, errorString]() {
+            if (self && self->m_generation == generation) {
+                self->fileFetched(name, md5, errorString);
+            }
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void OBSWorkingCopy::slotFileDownloadFailed(const QString &path, const QString &errorString)
+{
+    if (!m_fetching.contains(path)) {
+        return;
+    }
+    fail(QString("%1: %2").arg(m_fetching.value(path), errorString));
+}
+
+void OBSWorkingCopy::fileFetched(const QString &name, const QString &md5, const QString &errorString)
+{
+    if (!errorString.isEmpty()) {
+        fail(QString("%1: %2").arg(name, errorString));
+        return;
+    }
+    if (md5 != m_remoteMd5s.value(name)) {
+        // Changed on the server since it was listed, but it's what the server has
+        qDebug() << __PRETTY_FUNCTION__ << name << "changed while updating";
+        m_outdated = true;
+    }
+    m_base.insert(name, md5);
+    m_fetched++;
+    if (--m_pendingFetches == 0) {
+        finishUpdate();
+    }
+}
+
+void OBSWorkingCopy::finishUpdate()
+{
+    if (!m_outdated) {
+        m_srcmd5 = m_remoteSrcmd5;
+    }
+    if (!save()) {
+        fail(tr("Cannot write %1").arg(stateFileName()));
+        return;
+    }
+
+    QString message = tr("%1/%2: %3 files fetched, %4 removed")
+            .arg(m_project, m_package).arg(m_fetched).arg(m_deleted);
+    if (!m_conflicts.isEmpty()) {
+        message += tr(", changed on both sides: %1").arg(m_conflicts.join(", "));
+    }
+    if (m_outdated) {
+        message += tr(", the package changed while updating");
+    }
+    finish(message);
+}
+
+void OBSWorkingCopy::sendCommit()
+{
+    QStringList paths;
+    for (auto it = m_localMd5s.constBegin(); it != m_localMd5s.constEnd(); ++it) {
+        if (it.value() != m_base.value(it.key())) {
+            m_committed.append(it.key());
+            paths.append(filePath(it.key()));
+        }
+    }
+    if (paths.isEmpty()) {
+        fail(tr("No changes to commit"));
+        return;
+    }
+
+    // Don't overwrite changes made on the server since the last update
+    QStringList outdated;
+    for (const QString &name : m_committed) {
+        if (m_remoteMd5s.value(name) != m_base.value(name)) {
+            outdated.append(name);
+        }
+    }
+    if (!outdated.isEmpty()) {
+        fail(tr("Working copy out of date, update first: %1 changed on the server").arg(outdated.join(", ")));
+        return;
+    }
+
+    qDebug() << __PRETTY_FUNCTION__ << m_committed;
+    emit progress(tr("Committing %1 files...").arg(paths.size()));
+    m_request = m_obsCore->commitFiles(m_project, m_package, paths, m_comment);
+}
+
+void OBSWorkingCopy::slotFilesCommitted(const QString &project, const QString &package, const QString &srcmd5,
+                                        const QHash<QString, QString> &files)
+{
+    if (m_operation != Commit || m_committed.isEmpty() || project != m_project || package != m_package) {
+        return;
+    }
+
+    for (const QString &name : m_committed) {
+        m_base.insert(name, files.value(name));
+    }
+    // Other files may have changed on the server in the meantime
+    if (m_base == files) {
+        m_srcmd5 = srcmd5;
+    }
+    if (!save()) {
+        fail(tr("Cannot write %1").arg(stateFileName()));
+        return;
+    }
+    finish(tr("%1/%2: %3 files committed").arg(m_project, m_package).arg(m_committed.size()));
+}
+
+void OBSWorkingCopy::slotCommitFailed(const QString &project, const QString &package, const QString &errorString)
+{
+    if (m_operation != Commit || m_committed.isEmpty() || project != m_project || package != m_package) {
+        return;
+    }
+    fail(errorString);
+}
+
+void OBSWorkingCopy::slotNothingToCommit(const QString &project, const QString &package)
+{
+    if (m_operation != Commit || m_committed.isEmpty() || project != m_project || package != m_package) {
+        return;
+    }
+    // The server has the same files already
+    finish(tr("%1/%2: nothing to commit").arg(m_project, m_package));
+}
+
+void OBSWorkingCopy::finish(const QString &message)
+{
+    qDebug() << __PRETTY_FUNCTION__ << message;
+    m_operation = None;
+    m_generation++;
+    emit finished(message);
+}
+
+void OBSWorkingCopy::fail(const QString &errorString)
+{
+    qDebug() << __PRETTY_FUNCTION__ << errorString;
+    Operation operation = m_operation;
+    m_operation = None;
+    m_generation++;
+
+    m_obsCore->cancelRequest(m_request);
+    for (const OBSRequestHandle &handle : m_downloads) {
+        m_obsCore->cancelRequest(handle);
+    }
+    m_downloads.clear();
+    m_fetching.clear();
+
+    // Keep what has been fetched so far
+    if (operation == Update || operation == Checkout) {
+        save();
+    }
+    emit failed(errorString);
+}
@@ -0,0 +1,128 @@
+/*
+ *  Qactus - A Qt-based OBS client
+ *
+ *  Copyright (C) 2019 Javier Llorente <javier@opensuse.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) version 3.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OBSWORKINGCOPY_H
+#define OBSWORKINGCOPY_H
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include "obscore.h"
+#include "obsrequesthandle.h"
+
+/*
+ * OBSWorkingCopy keeps a package checked out in a directory. The md5 of
+ * every file of the revision checked out is kept in <directory>/.qactus,
+ * so local changes are found by hashing the files (in parallel, on the
+ * global thread pool) and comparing.
+ *
+ * update() fetches only the files that changed on the server and weren't
+ * changed locally, from the OBSBlobStore when possible, and removes those
+ * deleted on the server. Files changed on both sides are left alone and
+ * reported as conflicts. checkout() is an update of a new directory.
+ * commit() sends the files changed locally with OBSCore::commitFiles(),
+ * which uploads only what the server doesn't have.
+ *
+ * It must live in the GUI thread, and only one operation runs at a time.
+ *
+ */
+class OBSWorkingCopy : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Operation {
+        None,
+        Checkout,
+        Update,
+        Commit
+    };
+
+    explicit OBSWorkingCopy(const QString &directory, QObject *parent = nullptr);
+    static bool isWorkingCopy(const QString &directory);
+    QString getDirectory() const;
+    QString getProject() const;
+    QString getPackage() const;
+    QString getSrcmd5() const;
+    Operation getOperation() const;
+    bool checkout(const QString &project, const QString &package);
+    bool update();
+    bool commit(const QString &comment);
+    void cancel();
+
+signals:
+    void progress(const QString &message);
+    void finished(const QString &message);
+    void failed(const QString &errorString);
+
+private:
+    OBSCore *m_obsCore;
+    QString m_directory;
+    QString m_project;
+    QString m_package;
+    QString m_srcmd5;
+    QHash<QString, QString> m_base; // name -> md5 of the revision checked out
+    Operation m_operation;
+    int m_generation;
+    OBSRequestHandle m_request;
+    QList<OBSRequestHandle> m_downloads;
+    QHash<QString, QString> m_localMd5s;
+    QHash<QString, QString> m_remoteMd5s;
+    QString m_remoteSrcmd5;
+    int m_pendingHashes;
+    bool m_listed;
+    QHash<QString, QString> m_fetching; // path -> name
+    int m_pendingFetches;
+    int m_fetched;
+    int m_deleted;
+    bool m_outdated;
+    QStringList m_conflicts;
+    QStringList m_committed;
+    QString m_comment;
+    QString filePath(const QString &name) const;
+    QString stateFileName() const;
+    bool load();
+    bool save();
+    bool start(Operation operation);
+    void startUpdate();
+    void hashFiles(const QStringList &names);
+    void fileHashed(const QString &name, const QString &md5, const QString &errorString);
+    void applyUpdate();
+    void fetchFile(const QString &name, const QString &md5);
+    void downloadFile(const QString &name);
+    void fileFetched(const QString &name, const QString &md5, const QString &errorString);
+    void finishUpdate();
+    void sendCommit();
+    void finish(const QString &message);
+    void fail(const QString &errorString);
+
+private slots:
+    void slotFileMd5ListFetched(const QString &project, const QString &package, const QString &srcmd5,
+                                const QHash<QString, QString> &files);
+    void slotFileMd5ListFailed(const QString &project, const QString &package, const QString &errorString);
+    void slotFileDownloaded(const QString &path);
+    void slotFileDownloadFailed(const QString &path, const QString &errorString);
+    void slotFilesCommitted(const QString &project, const QString &package, const QString &srcmd5,
+                            const QHash<QString, QString> &files);
+    void slotNothingToCommit(const QString &project, const QString &package);
+    void slotCommitFailed(const QString &project, const QString &package, const QString &errorString);
+};
+
+#endif // OBSWORKINGCOPY_H
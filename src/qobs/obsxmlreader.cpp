@@ -20,235 +20,537 @@
 
 #include "obsxmlreader.h"
 
-OBSXmlReader *OBSXmlReader::instance = nullptr;
+namespace {
 
-OBSXmlReader::OBSXmlReader()
+/*
+ * An OBSXmlBinding maps an element name to the function reading it into T.
+ * Bindings which leave the reader on the start tag of their element get its
+ * children bound with the same table. Elements without a binding are skipped.
+ *
+ */
+template<typename T>
+struct OBSXmlBinding
 {
+    QLatin1String name;
+    void (*bind)(QXmlStreamReader &xml, T *object);
+};
+
+template<typename T, size_t N>
+void bindChildren(QXmlStreamReader &xml, T *object, const OBSXmlBinding<T> (&bindings)[N]);
 
+// Binds the element the reader is on, leaving the reader on its end tag
+template<typename T, size_t N>
+void bindElement(QXmlStreamReader &xml, T *object, const OBSXmlBinding<T> (&bindings)[N])
+{
+    const QStringRef name = xml.name();
+    for (const OBSXmlBinding<T> &binding : bindings) {
+        if (name == binding.name) {
+            binding.bind(xml, object);
+            if (xml.isStartElement()) {
+                bindChildren(xml, object, bindings);
+            }
+            return;
+        }
+    }
+    xml.skipCurrentElement();
 }
 
-OBSXmlReader *OBSXmlReader::getInstance()
+template<typename T, size_t N>
+void bindChildren(QXmlStreamReader &xml, T *object, const OBSXmlBinding<T> (&bindings)[N])
 {
-    if (!instance) {
-        instance = new OBSXmlReader();
+    // readNextStartElement() stops at the end tag, at the end of the data and on errors
+    while (xml.readNextStartElement()) {
+        bindElement(xml, object, bindings);
     }
-    return instance;
 }
 
-void OBSXmlReader::addData(const QString &data)
+// Calls function for every child element named name of the current element
+template<typename Function>
+void forEachElement(QXmlStreamReader &xml, QLatin1String name, Function function)
 {
-    qDebug() << "OBSXmlReader::addData()";
-    QXmlStreamReader xml(data);
+    while (xml.readNextStartElement()) {
+        if (xml.name() == name) {
+            function();
+        }
+        if (xml.isStartElement()) {
+            xml.skipCurrentElement();
+        }
+    }
+}
 
+// Reads what is left of the document, returns false if it's malformed
+bool finishDocument(QXmlStreamReader &xml)
+{
     while (!xml.atEnd() && !xml.hasError()) {
         xml.readNext();
-
-        if (xml.name()=="resultlist" && xml.isStartElement()) {
-            qDebug() << "OBSXmlReader: resultlist tag found";
-            parseResultList(data);
-            break;
-
-        } else if (xml.name()=="revisionlist" && xml.isStartElement()) {
-            qDebug() << "OBSXmlReader: revisionlist tag found";
-            parseRevisionList(data);
-        } else if (xml.name()=="status" && xml.isStartElement()) {
-            qDebug() << "OBSXmlReader: status tag found";
-            parseBuildStatus(data);
-        }
     }
+    if (xml.hasError()) {
+        qDebug() << "Error parsing XML!" << xml.errorString();
+        return false;
+    }
+    return true;
 }
 
-void OBSXmlReader::parseProjectList(const QString &userHome, const QString &data)
+template<typename T, size_t N>
+bool bindDocument(const QByteArray &data, T *object, const OBSXmlBinding<T> (&bindings)[N])
 {
     QXmlStreamReader xml(data);
+    if (xml.readNextStartElement()) {
+        bindElement(xml, object, bindings);
+    }
+    return finishDocument(xml);
+}
 
-    QStringList list;
+const OBSXmlBinding<OBSStatus> statusBindings[] = {
+    {QLatin1String("status"), [](QXmlStreamReader &xml, OBSStatus *status) {
+        QXmlStreamAttributes attrib = xml.attributes();
+        if (attrib.hasAttribute("package")) {
+            status->setPackage(attrib.value("package").toString());
+        }
+        status->setCode(attrib.value("code").toString());
+    }},
+    {QLatin1String("summary"), [](QXmlStreamReader &xml, OBSStatus *status) {
+        status->setSummary(xml.readElementText());
+    }},
+    {QLatin1String("details"), [](QXmlStreamReader &xml, OBSStatus *status) {
+        status->setDetails(xml.readElementText());
+    }}
+};
+
+const OBSXmlBinding<OBSResult> resultBindings[] = {
+    {QLatin1String("result"), [](QXmlStreamReader &xml, OBSResult *result) {
+        QXmlStreamAttributes attrib = xml.attributes();
+        result->setProject(attrib.value("project").toString());
+        result->setRepository(attrib.value("repository").toString());
+        result->setArch(attrib.value("arch").toString());
+        result->setCode(attrib.value("code").toString());
+        result->setState(attrib.value("state").toString());
+    }},
+    {QLatin1String("status"), [](QXmlStreamReader &xml, OBSResult *result) {
+        bindElement(xml, result->getStatus(), statusBindings);
+    }}
+};
+
+const OBSXmlBinding<OBSRevision> revisionBindings[] = {
+    {QLatin1String("revision"), [](QXmlStreamReader &xml, OBSRevision *revision) {
+        revision->setRev(xml.attributes().value("rev").toUInt());
+    }},
+    {QLatin1String("version"), [](QXmlStreamReader &xml, OBSRevision *revision) {
+        revision->setVersion(xml.readElementText());
+    }},
+    {QLatin1String("time"), [](QXmlStreamReader &xml, OBSRevision *revision) {
+        revision->setTime(xml.readElementText().toUInt());
+    }},
+    {QLatin1String("user"), [](QXmlStreamReader &xml, OBSRevision *revision) {
+        revision->setUser(xml.readElementText());
+    }},
+    {QLatin1String("comment"), [](QXmlStreamReader &xml, OBSRevision *revision) {
+        revision->setComment(xml.readElementText());
+    }}
+};
+
+// <review> and <history> are skipped, so their descriptions don't replace the request's
+const OBSXmlBinding<OBSRequest> requestBindings[] = {
+    {QLatin1String("request"), [](QXmlStreamReader &xml, OBSRequest *request) {
+        request->setId(xml.attributes().value("id").toString());
+    }},
+    {QLatin1String("action"), [](QXmlStreamReader &xml, OBSRequest *request) {
+        request->setActionType(xml.attributes().value("type").toString());
+    }},
+    {QLatin1String("source"), [](QXmlStreamReader &xml, OBSRequest *request) {
+        QXmlStreamAttributes attrib = xml.attributes();
+        request->setSourceProject(attrib.value("project").toString());
+        request->setSourcePackage(attrib.value("package").toString());
+    }},
+    {QLatin1String("target"), [](QXmlStreamReader &xml, OBSRequest *request) {
+        QXmlStreamAttributes attrib = xml.attributes();
+        request->setTargetProject(attrib.value("project").toString());
+        request->setTargetPackage(attrib.value("package").toString());
+    }},
+    {QLatin1String("state"), [](QXmlStreamReader &xml, OBSRequest *request) {
+        QXmlStreamAttributes attrib = xml.attributes();
+        request->setState(attrib.value("name").toString());
+        request->setRequester(attrib.value("who").toString());
+        QString date = attrib.value("when").toString();
+        // Replace the "T" (as in 2015-03-13T20:01:33)
+        date.replace(10, 1, " ");
+        request->setDate(date);
+        xml.skipCurrentElement();
+    }},
+    {QLatin1String("description"), [](QXmlStreamReader &xml, OBSRequest *request) {
+        request->setDescription(xml.readElementText());
+    }}
+};
+
+QHash<QString, bool> readRepositoryFlags(QXmlStreamReader &xml)
+{
+    QHash<QString, bool> flagHash;
+    while (xml.readNextStartElement()) {
+        bool enable = (xml.name() == QLatin1String("enable"));
+        if (enable || xml.name() == QLatin1String("disable")) {
+            QXmlStreamAttributes attrib = xml.attributes();
+            QString repository = attrib.hasAttribute("repository") ? attrib.value("repository").toString() : "all";
+            flagHash.insert(repository, enable);
+        }
+        xml.skipCurrentElement();
+    }
+    return flagHash;
+}
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
+// Elements shared by project and package meta configs
+template<typename T>
+void bindMetaTitle(QXmlStreamReader &xml, T *metaConfig)
+{
+    metaConfig->setTitle(xml.readElementText());
+}
 
-        if (xml.name()=="entry") {
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-                QString entry = attrib.value("name").toString();
-//                qDebug() << "Entry name: " << entry;
-                if (!userHome.isEmpty()) {
-                    if (entry.startsWith(userHome)) {
-                        list.append(entry);
-                        emit projectFetched(entry);
-                    }
-                    if (!entry.startsWith("home")) {
-                        list.append(entry);
-                        emit projectFetched(entry);
-                    }
-                } else {
-                    list.append(entry);
-                    emit projectFetched(entry);
-                }
-            }
-        } // end entry
+template<typename T>
+void bindMetaDescription(QXmlStreamReader &xml, T *metaConfig)
+{
+    metaConfig->setDescription(xml.readElementText());
+}
 
-    } // end while
+template<typename T>
+void bindMetaPerson(QXmlStreamReader &xml, T *metaConfig)
+{
+    QXmlStreamAttributes attrib = xml.attributes();
+    metaConfig->insertPerson(attrib.value("userid").toString(), attrib.value("role").toString());
+    xml.skipCurrentElement();
+}
 
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
-    }
+template<typename T>
+void bindMetaGroup(QXmlStreamReader &xml, T *metaConfig)
+{
+    QXmlStreamAttributes attrib = xml.attributes();
+    metaConfig->insertGroup(attrib.value("groupid").toString(), attrib.value("role").toString());
+    xml.skipCurrentElement();
+}
 
-    emit finishedParsingProjectList(list);
+template<typename T>
+void bindMetaBuild(QXmlStreamReader &xml, T *metaConfig)
+{
+    metaConfig->setBuildFlag(readRepositoryFlags(xml));
 }
 
-void OBSXmlReader::parsePrjMetaConfig(const QString &data)
+template<typename T>
+void bindMetaPublish(QXmlStreamReader &xml, T *metaConfig)
 {
-    QXmlStreamReader xml(data);
-    OBSPrjMetaConfig *prjMetaConfig = nullptr;
-    OBSRepository *repository = nullptr;
+    metaConfig->setPublishFlag(readRepositoryFlags(xml));
+}
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
+template<typename T>
+void bindMetaUseForBuild(QXmlStreamReader &xml, T *metaConfig)
+{
+    metaConfig->setUseForBuildFlag(readRepositoryFlags(xml));
+}
 
-        if (xml.name()=="project" && xml.isStartElement()) {
-            prjMetaConfig = new OBSPrjMetaConfig();
-            QXmlStreamAttributes attrib = xml.attributes();
-            prjMetaConfig->setName(attrib.value("name").toString());
-        }
+template<typename T>
+void bindMetaDebugInfo(QXmlStreamReader &xml, T *metaConfig)
+{
+    metaConfig->setDebugInfoFlag(readRepositoryFlags(xml));
+}
 
-        parseMetaConfig(xml, prjMetaConfig);
+const OBSXmlBinding<OBSRepository> repositoryBindings[] = {
+    {QLatin1String("repository"), [](QXmlStreamReader &xml, OBSRepository *repository) {
+        repository->setName(xml.attributes().value("name").toString());
+    }},
+    {QLatin1String("path"), [](QXmlStreamReader &xml, OBSRepository *repository) {
+        QXmlStreamAttributes attrib = xml.attributes();
+        repository->setProject(attrib.value("project").toString());
+        repository->setRepository(attrib.value("repository").toString());
+        xml.skipCurrentElement();
+    }},
+    {QLatin1String("arch"), [](QXmlStreamReader &xml, OBSRepository *repository) {
+        repository->appendArch(xml.readElementText());
+    }}
+};
+
+const OBSXmlBinding<OBSPrjMetaConfig> prjMetaConfigBindings[] = {
+    {QLatin1String("project"), [](QXmlStreamReader &xml, OBSPrjMetaConfig *prjMetaConfig) {
+        prjMetaConfig->setName(xml.attributes().value("name").toString());
+    }},
+    {QLatin1String("title"), bindMetaTitle<OBSPrjMetaConfig>},
+    {QLatin1String("description"), bindMetaDescription<OBSPrjMetaConfig>},
+    {QLatin1String("person"), bindMetaPerson<OBSPrjMetaConfig>},
+    {QLatin1String("group"), bindMetaGroup<OBSPrjMetaConfig>},
+    {QLatin1String("build"), bindMetaBuild<OBSPrjMetaConfig>},
+    {QLatin1String("publish"), bindMetaPublish<OBSPrjMetaConfig>},
+    {QLatin1String("useforbuild"), bindMetaUseForBuild<OBSPrjMetaConfig>},
+    {QLatin1String("debuginfo"), bindMetaDebugInfo<OBSPrjMetaConfig>},
+    {QLatin1String("repository"), [](QXmlStreamReader &xml, OBSPrjMetaConfig *prjMetaConfig) {
+        OBSRepository *repository = new OBSRepository();
+        bindElement(xml, repository, repositoryBindings);
+        prjMetaConfig->appendRepository(repository);
+    }}
+};
+
+const OBSXmlBinding<OBSPkgMetaConfig> pkgMetaConfigBindings[] = {
+    {QLatin1String("package"), [](QXmlStreamReader &xml, OBSPkgMetaConfig *pkgMetaConfig) {
+        QXmlStreamAttributes attrib = xml.attributes();
+        pkgMetaConfig->setName(attrib.value("name").toString());
+        pkgMetaConfig->setProject(attrib.value("project").toString());
+    }},
+    {QLatin1String("title"), bindMetaTitle<OBSPkgMetaConfig>},
+    {QLatin1String("description"), bindMetaDescription<OBSPkgMetaConfig>},
+    {QLatin1String("person"), bindMetaPerson<OBSPkgMetaConfig>},
+    {QLatin1String("group"), bindMetaGroup<OBSPkgMetaConfig>},
+    {QLatin1String("build"), bindMetaBuild<OBSPkgMetaConfig>},
+    {QLatin1String("publish"), bindMetaPublish<OBSPkgMetaConfig>},
+    {QLatin1String("useforbuild"), bindMetaUseForBuild<OBSPkgMetaConfig>},
+    {QLatin1String("debuginfo"), bindMetaDebugInfo<OBSPkgMetaConfig>},
+    {QLatin1String("url"), [](QXmlStreamReader &xml, OBSPkgMetaConfig *pkgMetaConfig) {
+        pkgMetaConfig->setUrl(QUrl(xml.readElementText()));
+    }}
+};
+
+const OBSXmlBinding<OBSDistribution> distributionBindings[] = {
+    {QLatin1String("distribution"), [](QXmlStreamReader &xml, OBSDistribution *distribution) {
+        QXmlStreamAttributes attrib = xml.attributes();
+        distribution->setVendor(attrib.value("vendor").toString());
+        distribution->setVersion(attrib.value("version").toString());
+        distribution->setId(attrib.value("id").toString());
+    }},
+    {QLatin1String("name"), [](QXmlStreamReader &xml, OBSDistribution *distribution) {
+        distribution->setName(xml.readElementText());
+    }},
+    {QLatin1String("project"), [](QXmlStreamReader &xml, OBSDistribution *distribution) {
+        distribution->setProject(xml.readElementText());
+    }},
+    {QLatin1String("reponame"), [](QXmlStreamReader &xml, OBSDistribution *distribution) {
+        distribution->setRepoName(xml.readElementText());
+    }},
+    {QLatin1String("repository"), [](QXmlStreamReader &xml, OBSDistribution *distribution) {
+        distribution->setRepository(xml.readElementText());
+    }},
+    {QLatin1String("link"), [](QXmlStreamReader &xml, OBSDistribution *distribution) {
+        distribution->setLink(QUrl(xml.readElementText()));
+    }},
+    {QLatin1String("icon"), [](QXmlStreamReader &xml, OBSDistribution *distribution) {
+        distribution->appendIcon(QUrl(xml.attributes().value("url").toString()));
+        xml.skipCurrentElement();
+    }},
+    {QLatin1String("architecture"), [](QXmlStreamReader &xml, OBSDistribution *distribution) {
+        distribution->appendArch(xml.readElementText());
+    }}
+};
+
+const OBSXmlBinding<OBSLink> linkBindings[] = {
+    {QLatin1String("link"), [](QXmlStreamReader &xml, OBSLink *link) {
+        QXmlStreamAttributes attrib = xml.attributes();
+        link->setProject(attrib.value("project").toString());
+        link->setPackage(attrib.value("package").toString());
+        xml.skipCurrentElement();
+    }}
+};
+
+const OBSXmlBinding<OBSAbout> aboutBindings[] = {
+    {QLatin1String("about"), [](QXmlStreamReader &, OBSAbout *) {}},
+    {QLatin1String("title"), [](QXmlStreamReader &xml, OBSAbout *about) {
+        about->setTitle(xml.readElementText());
+    }},
+    {QLatin1String("description"), [](QXmlStreamReader &xml, OBSAbout *about) {
+        about->setDescription(xml.readElementText());
+    }},
+    {QLatin1String("revision"), [](QXmlStreamReader &xml, OBSAbout *about) {
+        about->setRevision(xml.readElementText());
+    }},
+    {QLatin1String("last_deployment"), [](QXmlStreamReader &xml, OBSAbout *about) {
+        about->setLastDeployment(xml.readElementText());
+    }}
+};
+
+const OBSXmlBinding<OBSPerson> personBindings[] = {
+    {QLatin1String("person"), [](QXmlStreamReader &, OBSPerson *) {}},
+    {QLatin1String("login"), [](QXmlStreamReader &xml, OBSPerson *person) {
+        person->setLogin(xml.readElementText());
+    }},
+    {QLatin1String("email"), [](QXmlStreamReader &xml, OBSPerson *person) {
+        person->setEmail(xml.readElementText());
+    }},
+    {QLatin1String("realname"), [](QXmlStreamReader &xml, OBSPerson *person) {
+        person->setRealName(xml.readElementText());
+    }},
+    {QLatin1String("state"), [](QXmlStreamReader &xml, OBSPerson *person) {
+        person->setState(xml.readElementText());
+    }},
+    {QLatin1String("watchlist"), [](QXmlStreamReader &, OBSPerson *) {}},
+    {QLatin1String("project"), [](QXmlStreamReader &xml, OBSPerson *person) {
+        person->appendWatchItem(xml.attributes().value("name").toString());
+        xml.skipCurrentElement();
+    }}
+};
+
+} // namespace
 
-        if (xml.name()=="repository" && xml.isStartElement()) {
-            repository = new OBSRepository();
-            QXmlStreamAttributes attrib = xml.attributes();
-            repository->setName(attrib.value("name").toString());
+OBSXmlReader *OBSXmlReader::instance = nullptr;
 
-            while (xml.readNextStartElement()) {
-                if (xml.name()=="path" && xml.isStartElement()) {
-                    QXmlStreamAttributes attrib = xml.attributes();
-                    repository->setProject(attrib.value("project").toString());
-                    repository->setRepository(attrib.value("repository").toString());
-                }
-            }
+OBSXmlReader::OBSXmlReader(QObject *parent) :
+    QObject(parent),
+    row(0),
+    requestNumber(0)
+{
+    // Parsed by a reader of the parser thread, re-emitted by the hub
+    connect(this, &OBSXmlReader::requestCountFetched, this, [this](int count) {
+        requestNumber = count;
+    });
+}
 
-            while (xml.readNextStartElement()) {
-                if (xml.name()=="arch" && xml.isStartElement()) {
-                    repository->appendArch(xml.readElementText());
-                }
-            }
-        }
+OBSXmlReader *OBSXmlReader::getInstance()
+{
+    if (!instance) {
+        instance = new OBSXmlReader();
+    }
+    return instance;
+}
 
-        if (xml.name()=="repository" && xml.isEndElement()) {
-            prjMetaConfig->appendRepository(repository);
+void OBSXmlReader::registerMetaTypes()
+{
+    // Needed to queue the results of a parser running on another thread
+    qRegisterMetaType<OBSStatus*>("OBSStatus*");
+    qRegisterMetaType<OBSRevision*>("OBSRevision*");
+    qRegisterMetaType<OBSRequest*>("OBSRequest*");
+    qRegisterMetaType<OBSResult*>("OBSResult*");
+    qRegisterMetaType<OBSFile*>("OBSFile*");
+    qRegisterMetaType<QList<OBSFile>>("QList<OBSFile>");
+    qRegisterMetaType<QHash<QString, QString>>("QHash<QString,QString>");
+    qRegisterMetaType<OBSLink*>("OBSLink*");
+    qRegisterMetaType<OBSPrjMetaConfig*>("OBSPrjMetaConfig*");
+    qRegisterMetaType<OBSPkgMetaConfig*>("OBSPkgMetaConfig*");
+    qRegisterMetaType<OBSAbout*>("OBSAbout*");
+    qRegisterMetaType<OBSPerson*>("OBSPerson*");
+    qRegisterMetaType<OBSDistribution*>("OBSDistribution*");
+}
+
+void OBSXmlReader::forwardSignalsTo(OBSXmlReader *hub)
+{
+    // Every signal of this reader is re-emitted by hub in hub's thread
+    const QMetaObject *metaObject = &OBSXmlReader::staticMetaObject;
+    for (int i = metaObject->methodOffset(); i < metaObject->methodCount(); i++) {
+        QMetaMethod method = metaObject->method(i);
+        if (method.methodType() == QMetaMethod::Signal) {
+            connect(this, method, hub, method, Qt::QueuedConnection);
         }
     }
+}
 
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+void OBSXmlReader::addData(const QByteArray &data)
+{
+    qDebug() << "OBSXmlReader::addData()";
+    QXmlStreamReader xml(data);
+
+    if (!xml.readNextStartElement()) {
         return;
     }
 
-    emit finishedParsingProjectMetaConfig(prjMetaConfig);
+    if (xml.name() == QLatin1String("resultlist")) {
+        qDebug() << "OBSXmlReader: resultlist tag found";
+        parseResultList(data);
+    } else if (xml.name() == QLatin1String("revisionlist")) {
+        qDebug() << "OBSXmlReader: revisionlist tag found";
+        parseRevisionList(data);
+    } else if (xml.name() == QLatin1String("status")) {
+        qDebug() << "OBSXmlReader: status tag found";
+        parseBuildStatus(data);
+    }
 }
 
-void OBSXmlReader::parsePkgMetaConfig(const QString &data)
+QStringList OBSXmlReader::parseProjectList(const QString &userHome, const QByteArray &data)
 {
-    QXmlStreamReader xml(data);
-    OBSPkgMetaConfig *pkgMetaConfig = nullptr;
+    OBSListParser parser(userHome);
+    parseProjectListData(&parser, data);
+    return finishProjectList(&parser);
+}
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
+void OBSXmlReader::parseProjectListData(OBSListParser *parser, const QByteArray &data)
+{
+    QStringList entries = parser->addData(data);
+    if (entries.isEmpty()) {
+        return;
+    }
 
-        if (xml.name()=="package" && xml.isStartElement()) {
-            pkgMetaConfig = new OBSPkgMetaConfig();
-            QXmlStreamAttributes attrib = xml.attributes();
-            pkgMetaConfig->setName(attrib.value("name").toString());
-            pkgMetaConfig->setProject(attrib.value("project").toString());
-        }
+    bool first = (parser->getList().size() == entries.size());
+    emit projectListChunkFetched(entries, first);
+}
 
-        parseMetaConfig(xml, pkgMetaConfig);
+QStringList OBSXmlReader::finishProjectList(OBSListParser *parser)
+{
+    QStringList list = parser->getList();
+    emit finishedParsingProjectList(list);
+    return list;
+}
 
-        if (xml.name()=="url" && xml.isStartElement()) {
-            pkgMetaConfig->setUrl(QUrl(xml.readElementText()));
-        }
+void OBSXmlReader::replayProjectList(const QStringList &list)
+{
+    emit finishedParsingProjectList(list);
+}
 
-    }
+void OBSXmlReader::parsePrjMetaConfig(const QByteArray &data)
+{
+    OBSPrjMetaConfig *prjMetaConfig = new OBSPrjMetaConfig();
 
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, prjMetaConfig, prjMetaConfigBindings)) {
+        delete prjMetaConfig;
         return;
     }
+    emit finishedParsingProjectMetaConfig(prjMetaConfig);
+}
+
+void OBSXmlReader::parsePkgMetaConfig(const QByteArray &data)
+{
+    OBSPkgMetaConfig *pkgMetaConfig = new OBSPkgMetaConfig();
 
+    if (!bindDocument(data, pkgMetaConfig, pkgMetaConfigBindings)) {
+        delete pkgMetaConfig;
+        return;
+    }
     emit finishedParsingPackageMetaConfig(pkgMetaConfig);
 }
 
-void OBSXmlReader::parsePackageList(const QString &data)
+QStringList OBSXmlReader::parsePackageList(const QByteArray &data, const QString &project)
 {
-    QXmlStreamReader xml(data);
-    QStringList list = parseList(xml);
-    emit finishedParsingPackageList(list);
+    OBSListParser parser;
+    parsePackageListData(&parser, data, project);
+    return finishPackageList(&parser, project);
 }
 
-void OBSXmlReader::parseStatus(QXmlStreamReader &xml, OBSStatus *obsStatus)
+void OBSXmlReader::parsePackageListData(OBSListParser *parser, const QByteArray &data, const QString &project)
 {
-    qDebug() << "OBSXmlReader::parseStatus()";
-
-    if (xml.name()=="status") {
-        if (xml.isStartElement()) {
-            QXmlStreamAttributes attrib = xml.attributes();
-            if (attrib.hasAttribute("package")) {
-                obsStatus->setPackage(attrib.value("package").toString());
-            }
-            obsStatus->setCode(attrib.value("code").toString());
-            qDebug() << "Package:" << obsStatus->getPackage() << "Status code:" << obsStatus->getCode();
-
-        }
-    } // end status
+    QStringList entries = parser->addData(data);
+    if (entries.isEmpty()) {
+        return;
+    }
 
-    if (xml.name()=="summary" && xml.isStartElement()) {
-        xml.readNext();
-        obsStatus->setSummary(xml.text().toString());
-        qDebug() << "Status summary:" << obsStatus->getSummary();
-        // If user doesn't exist, return
-        if (xml.text().toString().startsWith("Couldn't find User with login")) {
-            return;
-        }
-    } // end summary
+    bool first = (parser->getList().size() == entries.size());
+    emit packageListChunkFetched(entries, project, first);
+}
 
-    if (xml.name()=="details" && xml.isStartElement()) {
-        xml.readNext();
-        obsStatus->setDetails(xml.text().toString());
-        qDebug() << "Status details:" << obsStatus->getDetails();
-    } // end details
+QStringList OBSXmlReader::finishPackageList(OBSListParser *parser, const QString &project)
+{
+    QStringList list = parser->getList();
+    emit finishedParsingPackageList(list, project);
+    return list;
+}
 
+void OBSXmlReader::replayPackageList(const QStringList &list, const QString &project)
+{
+    emit finishedParsingPackageList(list, project);
 }
 
-void OBSXmlReader::parseBuildStatus(const QString &data)
+void OBSXmlReader::parseBuildStatus(const QByteArray &data)
 {
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
     emit finishedParsingPackage(obsStatus, row);
 }
 
-OBSStatus *OBSXmlReader::parseNotFoundStatus(const QString &data)
+OBSStatus *OBSXmlReader::parseNotFoundStatus(const QByteArray &data)
 {
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
-
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
-    }
+    bindDocument(data, obsStatus, statusBindings);
     return obsStatus;
 }
 
@@ -257,868 +559,475 @@ void OBSXmlReader::setPackageRow(int row)
     this->row = row;
 }
 
-void OBSXmlReader::parseResultList(const QString &data)
+void OBSXmlReader::parseResultList(const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseResultList()";
     QXmlStreamReader xml(data);
-    OBSResult *obsResult = nullptr;
-    OBSStatus *obsStatus = nullptr;
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        if (xml.isStartElement()) {
+    if (xml.readNextStartElement()) {
+        forEachElement(xml, QLatin1String("result"), [this, &xml]() {
+            OBSResult *obsResult = new OBSResult();
+            bindElement(xml, obsResult, resultBindings);
+            qDebug() << obsResult->getProject()
+                     << obsResult->getRepository()
+                     << obsResult->getArch()
+                     << obsResult->getCode()
+                     << obsResult->getState();
+            emit finishedParsingResult(obsResult);
+        });
+    }
 
-            if (xml.name()=="resultlist") {
-                xml.readNextStartElement();
-            }
+    if (finishDocument(xml)) {
+        emit finishedParsingResultList();
+    }
+}
 
-            if (xml.name()=="result") {
-                obsResult = new OBSResult();
-                obsStatus = obsResult->getStatus();
-                QXmlStreamAttributes attrib = xml.attributes();
-                obsResult->setProject(attrib.value("project").toString());
-                obsResult->setRepository(attrib.value("repository").toString());
-                obsResult->setArch(attrib.value("arch").toString());
-                obsResult->setCode(attrib.value("code").toString());
-                obsResult->setState(attrib.value("state").toString());
-                qDebug() << obsResult->getProject()
-                         << obsResult->getRepository()
-                         << obsResult->getArch()
-                         << obsResult->getCode()
-                         << obsResult->getState();
-            }
+QString OBSXmlReader::parseResultListState(const QByteArray &data)
+{
+    QXmlStreamReader xml(data);
 
-            parseStatus(xml, obsStatus);
+    if (xml.readNextStartElement() && xml.name() == QLatin1String("resultlist")) {
+        return xml.attributes().value("state").toString();
+    }
 
-            if (xml.name()=="details") {
-                xml.readNext();
-                obsResult->getStatus()->setDetails(xml.text().toString());
-                qDebug() << "Details:" << obsResult->getStatus()->getDetails();
-            }
-        }
+    if (xml.hasError()) {
+        qDebug() << "Error parsing XML!" << xml.errorString();
+    }
+    return QString();
+}
 
-        if (xml.name()=="result" && xml.isEndElement()) {
-            emit finishedParsingResult(obsResult);
-        }
+QList<int> OBSXmlReader::parseProjectBuildStatus(const QString &project, const QMultiHash<QString, int> &rows,
+                                                 const QByteArray &data)
+{
+    // rows: "repository/arch/package" -> monitor rows
+    qDebug() << "OBSXmlReader::parseProjectBuildStatus()" << project;
+    QXmlStreamReader xml(data);
+    QSet<QString> foundBuilds;
+
+    if (xml.readNextStartElement()) {
+        forEachElement(xml, QLatin1String("result"), [&]() {
+            QXmlStreamAttributes attrib = xml.attributes();
+            QString repository = attrib.value("repository").toString();
+            QString arch = attrib.value("arch").toString();
+
+            forEachElement(xml, QLatin1String("status"), [&]() {
+                OBSStatus status;
+                bindElement(xml, &status, statusBindings);
+                QString build = QString("%1/%2/%3").arg(repository, arch, status.getPackage());
+                foundBuilds.insert(build);
+
+                for (int row : rows.values(build)) {
+                    OBSStatus *obsStatus = new OBSStatus(status);
+                    obsStatus->setProject(project);
+                    emit finishedParsingPackage(obsStatus, row);
+                }
+            });
+        });
+    }
+
+    // The builds that a malformed reply didn't get to are missing as well
+    if (!finishDocument(xml)) {
+        qDebug() << "OBSXmlReader::parseProjectBuildStatus() Falling back to the status of each build";
+    }
 
-        if (xml.name()=="resultlist" && xml.isEndElement()) {
-            emit finishedParsingResultList();
+    QList<int> missingRows;
+    for (const QString &build : rows.uniqueKeys()) {
+        if (!foundBuilds.contains(build)) {
+            missingRows.append(rows.values(build));
         }
     }
+    return missingRows;
 }
 
-void OBSXmlReader::parseRequestStatus(const QString &data)
+void OBSXmlReader::parseRequestStatus(const QByteArray &data)
 {
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus );
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
-
     emit finishedParsingRequestStatus(obsStatus);
 }
 
-void OBSXmlReader::parseBranchPackage(const QString &project, const QString &package, const QString &data)
+void OBSXmlReader::parseBranchPackage(const QString &project, const QString &package, const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseBranchPackage()";
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
     obsStatus->setProject(project);
     obsStatus->setPackage(package);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
-
     emit finishedParsingBranchPackage(obsStatus);
 }
 
-void OBSXmlReader::parseLinkPackage(const QString &project, const QString &package, const QString &data)
+void OBSXmlReader::parseLinkPackage(const QString &project, const QString &package, const QByteArray &data)
 {
     qDebug() << __PRETTY_FUNCTION__;
-    QXmlStreamReader xml(data);
     OBSRevision *obsRevision = new OBSRevision();
     obsRevision->setProject(project);
     obsRevision->setPackage(package);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseRevision(xml, obsRevision);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsRevision, revisionBindings)) {
+        delete obsRevision;
         return;
     }
-
     emit finishedParsingLinkPkgRevision(obsRevision);
 }
 
-void OBSXmlReader::parseCopyPackage(const QString &project, const QString &package, const QString &data)
+void OBSXmlReader::parseCopyPackage(const QString &project, const QString &package, const QByteArray &data)
 {
     qDebug() << __PRETTY_FUNCTION__;
-    QXmlStreamReader xml(data);
     OBSRevision *obsRevision = new OBSRevision();
     obsRevision->setProject(project);
     obsRevision->setPackage(package);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseRevision(xml, obsRevision);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsRevision, revisionBindings)) {
+        delete obsRevision;
         return;
     }
-
     emit finishedParsingCopyPkgRevision(obsRevision);
 }
 
-void OBSXmlReader::parseCreateRequest(const QString &data)
+void OBSXmlReader::parseCreateRequest(const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseCreateRequest()";
-    QXmlStreamReader xml(data);
-    OBSRequest *obsRequest = nullptr;
-
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        if (xml.name()=="request") {
-            obsRequest = parseRequest(xml);
-        }
-    } // end while
+    OBSRequest *obsRequest = new OBSRequest();
 
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsRequest, requestBindings)) {
+        delete obsRequest;
         return;
     }
-
     emit finishedParsingCreateRequest(obsRequest);
 }
 
-void OBSXmlReader::parseCreateRequestStatus(const QString &data)
+void OBSXmlReader::parseCreateRequestStatus(const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseCreateRequestStatus()";
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
-
     emit finishedParsingCreateRequestStatus(obsStatus);
 }
 
-void OBSXmlReader::parseCreateProject(const QString &project, const QString &data)
+void OBSXmlReader::parseCreateProject(const QString &project, const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseCreateProject()";
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
     obsStatus->setProject(project);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
-
     emit finishedParsingCreatePrjStatus(obsStatus);
 }
 
-void OBSXmlReader::parseCreatePackage(const QString &project, const QString &package,const QString &data)
+void OBSXmlReader::parseCreatePackage(const QString &project, const QString &package,const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseCreatePackage()";
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
     obsStatus->setProject(project);
     obsStatus->setPackage(package);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
-
     emit finishedParsingCreatePkgStatus(obsStatus);
 }
 
-void OBSXmlReader::parseUploadFile(const QString &project, const QString &package, const QString &file, const QString &data)
+void OBSXmlReader::parseUploadFile(const QString &project, const QString &package, const QString &file, const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseUploadFile()";
-    QXmlStreamReader xml(data);
     OBSRevision *obsRevision = new OBSRevision();
     obsRevision->setProject(project);
     obsRevision->setPackage(package);
     obsRevision->setFile(file);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseRevision(xml, obsRevision);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsRevision, revisionBindings)) {
+        delete obsRevision;
         return;
     }
-
     emit finishedParsingUploadFileRevision(obsRevision);
 }
 
-void OBSXmlReader::parseDeleteProject(const QString &project, const QString &data)
+void OBSXmlReader::parseDeleteProject(const QString &project, const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseDeleteProject()";
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
     obsStatus->setProject(project);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
-
     emit finishedParsingDeletePrjStatus(obsStatus);
 }
 
-void OBSXmlReader::parseDeletePackage(const QString &project, const QString &package, const QString &data)
+void OBSXmlReader::parseDeletePackage(const QString &project, const QString &package, const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseDeletePackage()";
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
     obsStatus->setProject(project);
     obsStatus->setPackage(package);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
-
     emit finishedParsingDeletePkgStatus(obsStatus);
 }
 
-void OBSXmlReader::parseDeleteFile(const QString &project, const QString &package, const QString &fileName, const QString &data)
+void OBSXmlReader::parseDeleteFile(const QString &project, const QString &package, const QString &fileName, const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseDeleteFile()";
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
     obsStatus->setProject(project);
     obsStatus->setPackage(package);
     obsStatus->setDetails(fileName);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
-
     emit finishedParsingDeleteFileStatus(obsStatus);
 }
 
-void OBSXmlReader::parseRevision(QXmlStreamReader &xml, OBSRevision *obsRevision)
-{
-    if (xml.name()=="revision") {
-        QXmlStreamAttributes attrib = xml.attributes();
-        obsRevision->setRev(attrib.value("rev").toUInt());
-    }
-    if (xml.name()==("version")) {
-        xml.readNext();
-        obsRevision->setVersion(xml.text().toString());
-    }
-    if (xml.name()==("time")) {
-        xml.readNext();
-        obsRevision->setTime(xml.text().toUInt());
-    }
-    if (xml.name()==("user")) {
-        xml.readNext();
-        obsRevision->setUser(xml.text().toString());
-    }
-    if (xml.name()==("comment")) {
-        xml.readNext();
-        obsRevision->setComment(xml.text().toString());
-    }
-}
-
-void OBSXmlReader::parseRevisionList(const QString &data)
+void OBSXmlReader::parseRevisionList(const QByteArray &data)
 {
     QXmlStreamReader xml(data);
-    OBSRevision *obsRevision = nullptr;
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        if (xml.isStartElement()) {
-
-            if (xml.name()=="revisionlist") {
-                xml.readNextStartElement();
-            }
-
-            obsRevision = new OBSRevision();
-            parseRevision(xml, obsRevision);
-
-        }
-
-        if (xml.name()=="revision" && xml.isEndElement()) {
+    if (xml.readNextStartElement()) {
+        forEachElement(xml, QLatin1String("revision"), [this, &xml]() {
+            OBSRevision *obsRevision = new OBSRevision();
+            bindElement(xml, obsRevision, revisionBindings);
             emit finishedParsingRevision(obsRevision);
-        }
+        });
     }
+    finishDocument(xml);
 }
 
-void OBSXmlReader::parseCollection(QXmlStreamReader &xml)
-{
-    if (xml.name()=="collection") {
-        if (xml.isStartElement()) {
-            QXmlStreamAttributes attrib = xml.attributes();
-            QStringRef matches = attrib.value("matches");
-            QStringRef code = attrib.value("code");
-            requestNumber = matches.toString();
-
-            qDebug() << "Collection matches:" << requestNumber;
-        }
-    } // collection
-}
-
-void OBSXmlReader::parseIncomingRequests(const QString &data)
+void OBSXmlReader::parseRequestCollection(const QByteArray &data, void (OBSXmlReader::*requestParsed)(OBSRequest *),
+                                          void (OBSXmlReader::*listParsed)())
 {
     QXmlStreamReader xml(data);
-    OBSRequest *obsRequest = nullptr;
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-
-        parseCollection(xml);
-
-        if (xml.name()=="request" && xml.isStartElement()) {
-            obsRequest = parseRequest(xml);
-            if (xml.name()=="request" && xml.isEndElement()) {
-                emit finishedParsingIncomingRequest(obsRequest);
-            }
-        } // request
+    if (xml.readNextStartElement() && xml.name() == QLatin1String("collection")) {
+        int matches = xml.attributes().value("matches").toInt();
+        qDebug() << "Collection matches:" << matches;
+        emit requestCountFetched(matches);
 
-        if (xml.name()=="collection" && xml.isEndElement()) {
-            emit finishedParsingIncomingRequestList();
-        }
+        forEachElement(xml, QLatin1String("request"), [this, &xml, requestParsed]() {
+            OBSRequest *obsRequest = new OBSRequest();
+            bindElement(xml, obsRequest, requestBindings);
+            emit (this->*requestParsed)(obsRequest);
+        });
     }
 
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
-        return;
+    if (finishDocument(xml)) {
+        emit (this->*listParsed)();
     }
 }
 
-void OBSXmlReader::parseOutgoingRequests(const QString &data)
+void OBSXmlReader::parseIncomingRequests(const QByteArray &data)
 {
-    QXmlStreamReader xml(data);
-    OBSRequest *obsRequest = nullptr;
-
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-
-        parseCollection(xml);
-
-        if (xml.name()=="request" && xml.isStartElement()) {
-            obsRequest = parseRequest(xml);
-            if (xml.name()=="request" && xml.isEndElement()) {
-                emit finishedParsingOutgoingRequest(obsRequest);
-            }
-        } // request
-
-        if (xml.name()=="collection" && xml.isEndElement()) {
-            emit finishedParsingOutgoingRequestList();
-        }
-
-    }
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
-        return;
-    }
+    parseRequestCollection(data, &OBSXmlReader::finishedParsingIncomingRequest,
+                           &OBSXmlReader::finishedParsingIncomingRequestList);
 }
 
-void OBSXmlReader::parseDeclinedRequests(const QString &data)
+void OBSXmlReader::parseOutgoingRequests(const QByteArray &data)
 {
-    QXmlStreamReader xml(data);
-    OBSRequest *obsRequest = nullptr;
-
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-
-        parseCollection(xml);
-
-        if (xml.name()=="request" && xml.isStartElement()) {
-            obsRequest = parseRequest(xml);
-            if (xml.name()=="request" && xml.isEndElement()) {
-                emit finishedParsingDeclinedRequest(obsRequest);
-            }
-        } // request
-
-        if (xml.name()=="collection" && xml.isEndElement()) {
-            emit finishedParsingDeclinedRequestList();
-        }
-
-    }
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
-        return;
-    }
+    parseRequestCollection(data, &OBSXmlReader::finishedParsingOutgoingRequest,
+                           &OBSXmlReader::finishedParsingOutgoingRequestList);
 }
 
-OBSRequest *OBSXmlReader::parseRequest(QXmlStreamReader &xml)
+void OBSXmlReader::parseDeclinedRequests(const QByteArray &data)
 {
-    OBSRequest *obsRequest = nullptr;
-
-    if (xml.name()=="request") {
-        if (xml.isStartElement()) {
-            obsRequest = new OBSRequest();
-            QXmlStreamAttributes attrib = xml.attributes();
-            obsRequest->setId(attrib.value("id").toString());
-        }
-    } // request
-
-    while (!(xml.name()=="request" && xml.isEndElement())) {
-        xml.readNext();
-
-        if (xml.name()=="action")  {
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-                obsRequest->setActionType(attrib.value("type").toString());
-                qDebug() << "Action type:" <<  obsRequest->getActionType();
-            }
-        } // action
-
-        if (xml.name()=="source") {
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-                obsRequest->setSourceProject(attrib.value("project").toString());
-                obsRequest->setSourcePackage(attrib.value("package").toString());
-                qDebug() << "Source: " <<  obsRequest->getSource();
-            }
-        } // source
-
-        if (xml.name()=="target") {
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-                obsRequest->setTargetProject(attrib.value("project").toString());
-                obsRequest->setTargetPackage(attrib.value("package").toString());
-                qDebug() << "Target: " <<  obsRequest->getTarget();
-            }
-        } // target
-
-        if (xml.name()=="state") {
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-                obsRequest->setState(attrib.value("name").toString());
-                qDebug() << "State: " <<  obsRequest->getState();
-                obsRequest->setRequester(attrib.value("who").toString());
-                qDebug() << "Requester: " <<  obsRequest->getRequester();
-                QString date = attrib.value("when").toString();
-                // Replace the "T" (as in 2015-03-13T20:01:33)
-                date.replace(10, 1, " ");
-                obsRequest->setDate(date);
-                qDebug() << "Date: " <<  obsRequest->getDate();
-            }
-        } // state
-
-        if (xml.name()=="description") {
-            if (xml.isStartElement()) {
-                xml.readNext();
-                obsRequest->setDescription(xml.text().toString());
-                qDebug() << "Description:\n" <<  obsRequest->getDescription();
-                // if tag is not empty (ie: <description/>), read next start element
-                if (!xml.text().isEmpty()) {
-                    xml.readNextStartElement();
-                }
-            }
-        } // description
-    }
-    return obsRequest;
+    parseRequestCollection(data, &OBSXmlReader::finishedParsingDeclinedRequest,
+                           &OBSXmlReader::finishedParsingDeclinedRequestList);
 }
 
-QStringList OBSXmlReader::parseList(QXmlStreamReader &xml)
+void OBSXmlReader::parseFileList(const QString &project, const QString &package, const QByteArray &data)
 {
-    qDebug() << "OBSXmlReader::parseList()";
-    QStringList list;
-    while (!xml.atEnd() && !xml.hasError()) {
-
-        xml.readNext();
-
-        if (xml.name()=="entry") {
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-
-                if (attrib.value("code").toString() == "unregistered_ichain_user") {
-                    qDebug() << "Unregistered username!";
-                } else {
-//                    qDebug() << "Name: " << attrib.value("name").toString();
-                    list.append(attrib.value("name").toString());
-                }
-            }
-        } // end entry
-
-        if (xml.name()=="repository") {
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-
-                if (attrib.value("code").toString() == "unregistered_ichain_user") {
-                    qDebug() << "Unregistered username!";
-                } else {
-//                    qDebug() << "Repository: " << attrib.value("name").toString();
-                    list.append(attrib.value("name").toString());
-                }
-            }
-        } // end repository
-
-    } // end while
+    qDebug() << "OBSXmlReader::parseFileList()";
+    QXmlStreamReader xml(data);
 
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (xml.readNextStartElement()) {
+        forEachElement(xml, QLatin1String("entry"), [this, &xml, &project, &package]() {
+            QXmlStreamAttributes attrib = xml.attributes();
+            OBSFile *obsFile = new OBSFile();
+            obsFile->setProject(project);
+            obsFile->setPackage(package);
+            obsFile->setName(attrib.value("name").toString());
+            obsFile->setSize(attrib.value("size").toString());
+            obsFile->setLastModified(attrib.value("mtime").toString());
+            obsFile->setMd5(attrib.value("md5").toString());
+            emit finishedParsingFile(obsFile);
+        });
     }
-
-    return list;
+    finishDocument(xml);
+    emit finishedParsingFileList();
 }
 
-void OBSXmlReader::parseMetaConfig(QXmlStreamReader &xml, OBSMetaConfig *metaConfig)
+void OBSXmlReader::parseBinaryList(const QString &project, const QString &repository, const QString &arch,
+                                   const QString &package, const QByteArray &data)
 {
-    if (xml.name()=="title" && xml.isStartElement()) {
-        metaConfig->setTitle(xml.readElementText());
-    }
-
-    if (xml.name()=="description" && xml.isStartElement()) {
-        metaConfig->setDescription(xml.readElementText());
-    }
-
-    if (xml.name()=="person" && xml.isStartElement()) {
-        QXmlStreamAttributes attrib = xml.attributes();
-        metaConfig->insertPerson(attrib.value("userid").toString(),
-                                 attrib.value("role").toString());
-    }
-
-    if (xml.name()=="group" && xml.isStartElement()) {
-        QXmlStreamAttributes attrib = xml.attributes();
-        metaConfig->insertGroup(attrib.value("groupid").toString(),
-                                attrib.value("role").toString());
-    }
-
-    if (xml.name()=="build" && xml.isStartElement()) {
-        metaConfig->setBuildFlag(parseRepositoryFlags(xml));
-    }
-
-    if (xml.name()=="publish" && xml.isStartElement()) {
-        metaConfig->setPublishFlag(parseRepositoryFlags(xml));
-    }
+    qDebug() << "OBSXmlReader::parseBinaryList()";
+    QXmlStreamReader xml(data);
+    QList<OBSFile> binaries;
 
-    if (xml.name()=="useforbuild" && xml.isStartElement()) {
-        metaConfig->setUseForBuildFlag(parseRepositoryFlags(xml));
+    if (xml.readNextStartElement()) {
+        forEachElement(xml, QLatin1String("binary"), [&]() {
+            QXmlStreamAttributes attrib = xml.attributes();
+            OBSFile binary;
+            binary.setProject(project);
+            binary.setPackage(package);
+            binary.setName(attrib.value("filename").toString());
+            binary.setSize(attrib.value("size").toString());
+            binary.setLastModified(attrib.value("mtime").toString());
+            binaries.append(binary);
+        });
     }
 
-    if (xml.name()=="debuginfo" && xml.isStartElement()) {
-        metaConfig->setDebugInfoFlag(parseRepositoryFlags(xml));
+    if (!finishDocument(xml)) {
+        return;
     }
+    emit finishedParsingBinaryList(project, repository, arch, package, binaries);
 }
 
-QHash<QString, bool> OBSXmlReader::parseRepositoryFlags(QXmlStreamReader &xml)
+QHash<QString, QString> OBSXmlReader::parseFileMd5List(const QByteArray &data, QString *srcmd5)
 {
-    QHash<QString, bool> flagHash;
-    while (xml.readNextStartElement()) {
-        if (xml.name() == "enable") {
-            QXmlStreamAttributes attrib = xml.attributes();
-            if (!attrib.hasAttribute("repository")) {
-                flagHash.insert("all", true);
-            } else {
-                QString repository = attrib.value("repository").toString();
-                flagHash.insert(repository, true);
-            }
-            xml.readNext();
-        }
+    qDebug() << "OBSXmlReader::parseFileMd5List()";
+    QXmlStreamReader xml(data);
+    QHash<QString, QString> files;
 
-        if (xml.name() == "disable") {
-            QXmlStreamAttributes attrib = xml.attributes();
-            if (!attrib.hasAttribute("repository")) {
-                flagHash.insert("all", false);
-            } else {
-                QString repository = attrib.value("repository").toString();
-                flagHash.insert(repository, false);
-            }
-            xml.readNext();
+    if (xml.readNextStartElement()) {
+        if (srcmd5) {
+            *srcmd5 = xml.attributes().value("srcmd5").toString();
         }
+        forEachElement(xml, QLatin1String("entry"), [&xml, &files]() {
+            QXmlStreamAttributes attrib = xml.attributes();
+            files.insert(attrib.value("name").toString(), attrib.value("md5").toString());
+        });
     }
-
-    return flagHash;
+    finishDocument(xml);
+    return files;
 }
 
-OBSDistribution *OBSXmlReader::parseDistribution(QXmlStreamReader &xml)
+QString OBSXmlReader::parseSrcmd5(const QByteArray &data)
 {
-    OBSDistribution *distribution = nullptr;
+    QXmlStreamReader xml(data);
 
-    if (xml.name()=="distribution" && xml.isStartElement()) {
-        distribution = new OBSDistribution();
-        QXmlStreamAttributes attrib = xml.attributes();
-        distribution->setVendor(attrib.value("vendor").toString());
-        distribution->setVersion(attrib.value("version").toString());
-        distribution->setId(attrib.value("id").toString());
+    if (xml.readNextStartElement() && xml.name() == QLatin1String("directory")) {
+        return xml.attributes().value("srcmd5").toString();
     }
+    return QString();
+}
 
-    while (!(xml.name()=="distribution" && xml.isEndElement())) {
-        xml.readNext();
-
-        if (xml.name()=="name" && xml.isStartElement()) {
-            distribution->setName(xml.readElementText());
-        }
-
-        if (xml.name()=="project" && xml.isStartElement()) {
-            distribution->setProject(xml.readElementText());
-        }
-
-        if (xml.name()=="reponame" && xml.isStartElement()) {
-            distribution->setRepoName(xml.readElementText());
-        }
-
-        if (xml.name()=="repository" && xml.isStartElement()) {
-            distribution->setRepository(xml.readElementText());
-        }
-
-        if (xml.name()=="link" && xml.isStartElement()) {
-            distribution->setLink(QUrl(xml.readElementText()));
-        }
-
-        if (xml.name()=="icon" && xml.isStartElement()) {
-            QXmlStreamAttributes attrib = xml.attributes();
-            distribution->appendIcon(QUrl(attrib.value("url").toString()));
-        }
-
-        if (xml.name()=="architecture" && xml.isStartElement()) {
-            distribution->appendArch(xml.readElementText());
-        }
+QStringList OBSXmlReader::parseMissingFiles(const QByteArray &data)
+{
+    qDebug() << "OBSXmlReader::parseMissingFiles()";
+    QXmlStreamReader xml(data);
+    QStringList missingFiles;
+
+    // <directory error="missing"> lists the files the server doesn't have
+    if (xml.readNextStartElement() && xml.name() == QLatin1String("directory") &&
+            xml.attributes().value("error") == QLatin1String("missing")) {
+        forEachElement(xml, QLatin1String("entry"), [&xml, &missingFiles]() {
+            missingFiles.append(xml.attributes().value("name").toString());
+        });
     }
-
-    return distribution;
+    finishDocument(xml);
+    return missingFiles;
 }
 
-void OBSXmlReader::parseFileList(const QString &project, const QString &package, const QString &data)
+void OBSXmlReader::parseCommitFileList(const QString &project, const QString &package, const QByteArray &data)
 {
-    qDebug() << "OBSXmlReader::parseFileList()";
+    qDebug() << "OBSXmlReader::parseCommitFileList()";
     QXmlStreamReader xml(data);
+    OBSRevision *obsRevision = new OBSRevision();
+    obsRevision->setProject(project);
+    obsRevision->setPackage(package);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-
-        xml.readNext();
-
-        if (xml.name()=="entry") {
-            OBSFile *obsFile = nullptr;
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-                qDebug() << "Name: " << attrib.value("name").toString();
-                qDebug() << "Size: " << attrib.value("size").toString();
-                qDebug() << "Mtime: " << attrib.value("mtime").toString();
-                obsFile = new OBSFile();
-                obsFile->setProject(project);
-                obsFile->setPackage(package);
-                obsFile->setName(attrib.value("name").toString());
-                obsFile->setSize(attrib.value("size").toString());
-                obsFile->setLastModified(attrib.value("mtime").toString());
-                emit finishedParsingFile(obsFile);
-            }
-        } // end entry
+    if (xml.readNextStartElement() && xml.name() == QLatin1String("directory")) {
+        obsRevision->setRev(xml.attributes().value("rev").toUInt());
+    }
 
-    } // end while
-    emit finishedParsingFileList();
+    if (!finishDocument(xml)) {
+        delete obsRevision;
+        return;
+    }
+    emit finishedParsingCommitRevision(obsRevision);
 }
 
-void OBSXmlReader::parseLink(const QString &data)
+void OBSXmlReader::parseLink(const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseLink()";
-    QXmlStreamReader xml(data);
     OBSLink *obsLink = new OBSLink();
 
-    while (!xml.atEnd() && !xml.hasError()) {
-
-        xml.readNext();
-
-        if (xml.name()=="link") {
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-                obsLink->setProject(attrib.value("project").toString());
-                obsLink->setPackage(attrib.value("package").toString());
-            }
-        } // end link
-
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsLink, linkBindings)) {
         delete obsLink;
         return;
     }
-
     emit finishedParsingLink(obsLink);
 }
 
-void OBSXmlReader::parseAbout(const QString &data)
+void OBSXmlReader::parseAbout(const QByteArray &data)
 {
-    QXmlStreamReader xml(data);
     OBSAbout *obsAbout = new OBSAbout();
 
-    while (!xml.atEnd() && !xml.hasError()) {
-
-        xml.readNext();
-
-        if (xml.name()=="title" && xml.isStartElement()) {
-            xml.readNext();
-            obsAbout->setTitle(xml.text().toString());
-        }
-
-        if (xml.name()=="description" && xml.isStartElement()) {
-            xml.readNext();
-            obsAbout->setDescription(xml.text().toString());
-        }
-
-        if (xml.name()=="revision" && xml.isStartElement()) {
-            xml.readNext();
-            obsAbout->setRevision(xml.text().toString());
-        }
-
-        if (xml.name()=="last_deployment" && xml.isStartElement()) {
-            xml.readNext();
-            obsAbout->setLastDeployment(xml.text().toString());
-        }
-
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsAbout, aboutBindings)) {
+        delete obsAbout;
         return;
     }
-
     emit finishedParsingAbout(obsAbout);
 }
 
-void OBSXmlReader::parsePerson(const QString &data)
+void OBSXmlReader::parsePerson(const QByteArray &data)
 {
-    QXmlStreamReader xml(data);
     OBSPerson *obsPerson = new OBSPerson();
 
-    while (!xml.atEnd() && !xml.hasError()) {
-
-        xml.readNext();
-
-        if (xml.name()=="login" && xml.isStartElement()) {
-            xml.readNext();
-            obsPerson->setLogin(xml.text().toString());
-        }
-
-        if (xml.name()=="email" && xml.isStartElement()) {
-            xml.readNext();
-            obsPerson->setEmail(xml.text().toString());
-        }
-
-        if (xml.name()=="realname" && xml.isStartElement()) {
-            xml.readNext();
-            obsPerson->setRealName(xml.text().toString());
-        }
-
-        if (xml.name()=="state" && xml.isStartElement()) {
-            xml.readNext();
-            obsPerson->setState(xml.text().toString());
-        }
-
-        if (xml.name()=="project") {
-            if (xml.isStartElement()) {
-                QXmlStreamAttributes attrib = xml.attributes();
-                obsPerson->appendWatchItem(attrib.value("name").toString());
-            }
-        }
-
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsPerson, personBindings)) {
+        delete obsPerson;
         return;
     }
-
     emit finishedParsingPerson(obsPerson);
 }
 
-void OBSXmlReader::parseUpdatePerson(const QString &data)
+void OBSXmlReader::parseUpdatePerson(const QByteArray &data)
 {
     qDebug() << "OBSXmlReader::parseUpdatePerson()";
-    QXmlStreamReader xml(data);
     OBSStatus *obsStatus = new OBSStatus();
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        parseStatus(xml, obsStatus);
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
+    if (!bindDocument(data, obsStatus, statusBindings)) {
+        delete obsStatus;
         return;
     }
-
     emit finishedParsingUpdatePerson(obsStatus);
 }
 
-void OBSXmlReader::parseDistributions(const QString &data)
+void OBSXmlReader::parseDistributions(const QByteArray &data)
 {
     QXmlStreamReader xml(data);
 
-    while (!xml.atEnd() && !xml.hasError()) {
-        xml.readNext();
-        if (xml.name()=="distributions" && xml.isStartElement()) {
-            xml.readNextStartElement();
-        }
-        if (xml.name()=="distribution" && xml.isStartElement()) {
-            OBSDistribution *distribution = parseDistribution(xml);
+    if (xml.readNextStartElement()) {
+        forEachElement(xml, QLatin1String("distribution"), [this, &xml]() {
+            OBSDistribution *distribution = new OBSDistribution();
+            bindElement(xml, distribution, distributionBindings);
             emit finishedParsingDistribution(distribution);
-        }
-
-    } // end while
-
-    if (xml.hasError()) {
-        qDebug() << "Error parsing XML!" << xml.errorString();
-        return;
+        });
     }
+    finishDocument(xml);
 }
 
 int OBSXmlReader::getRequestNumber()
 {
-    return requestNumber.toInt();
+    return requestNumber;
 }
@@ -22,8 +22,11 @@
 #define OBSXMLREADER_H
 
 #include <QXmlStreamReader>
+#include <QMetaMethod>
 #include <QDebug>
 #include <QStringList>
+#include <QHash>
+#include <QSet>
 #include <QFile>
 #include <QDir>
 #include <QDesktopServices>
@@ -39,61 +42,70 @@
 #include "obsprjmetaconfig.h"
 #include "obspkgmetaconfig.h"
 #include "obsdistribution.h"
+#include "obslistparser.h"
 
 class OBSXmlReader : public QObject
 {
     Q_OBJECT
 
 public:
+    explicit OBSXmlReader(QObject *parent = nullptr);
     static OBSXmlReader *getInstance();
-    void addData(const QString &data);
+    static void registerMetaTypes();
+    void forwardSignalsTo(OBSXmlReader *hub);
+    void addData(const QByteArray &data);
     void setPackageRow(int row);
-    void parseProjectList(const QString &userHome, const QString &data);
-    void parsePrjMetaConfig(const QString &data);
-    void parsePkgMetaConfig(const QString &data);
-    void parseBuildStatus(const QString &data);
-    OBSStatus *parseNotFoundStatus(const QString &data);
-    void parsePackageList(const QString &data);
-    void parseFileList(const QString &project, const QString &package, const QString &data);
-    void parseLink(const QString &data);
-    void parseResultList(const QString &data);
-    void parseIncomingRequests(const QString &data);
-    void parseOutgoingRequests(const QString &data);
-    void parseDeclinedRequests(const QString &data);
-    void parseRequestStatus(const QString &data);
-    void parseBranchPackage(const QString &project, const QString &package, const QString &data);
-    void parseLinkPackage(const QString &project, const QString &package, const QString &data);
-    void parseCopyPackage(const QString &project, const QString &package, const QString &data);
-    void parseCreateRequest(const QString &data);
-    void parseCreateRequestStatus(const QString &data);
-    void parseCreateProject(const QString &project, const QString &data);
-    void parseCreatePackage(const QString &package, const QString &project, const QString &data);
-    void parseUploadFile(const QString &project, const QString &package, const QString &file, const QString &data);
-    void parseDeleteProject(const QString &project, const QString &data);
-    void parseDeletePackage(const QString &project, const QString &package, const QString &data);
-    void parseDeleteFile(const QString &project, const QString &package, const QString &fileName, const QString &data);
+    QStringList parseProjectList(const QString &userHome, const QByteArray &data);
+    void parseProjectListData(OBSListParser *parser, const QByteArray &data);
+    QStringList finishProjectList(OBSListParser *parser);
+    void replayProjectList(const QStringList &list);
+    void parsePrjMetaConfig(const QByteArray &data);
+    void parsePkgMetaConfig(const QByteArray &data);
+    void parseBuildStatus(const QByteArray &data);
+    OBSStatus *parseNotFoundStatus(const QByteArray &data);
+    QStringList parsePackageList(const QByteArray &data, const QString &project = QString());
+    void parsePackageListData(OBSListParser *parser, const QByteArray &data, const QString &project = QString());
+    QStringList finishPackageList(OBSListParser *parser, const QString &project = QString());
+    void replayPackageList(const QStringList &list, const QString &project = QString());
+    void parseFileList(const QString &project, const QString &package, const QByteArray &data);
+    void parseBinaryList(const QString &project, const QString &repository, const QString &arch,
+                         const QString &package, const QByteArray &data);
+    QHash<QString, QString> parseFileMd5List(const QByteArray &data, QString *srcmd5 = nullptr);
+    QString parseSrcmd5(const QByteArray &data);
+    QStringList parseMissingFiles(const QByteArray &data);
+    void parseCommitFileList(const QString &project, const QString &package, const QByteArray &data);
+    void parseLink(const QByteArray &data);
+    void parseResultList(const QByteArray &data);
+    QString parseResultListState(const QByteArray &data);
+    QList<int> parseProjectBuildStatus(const QString &project, const QMultiHash<QString, int> &rows, const QByteArray &data);
+    void parseIncomingRequests(const QByteArray &data);
+    void parseOutgoingRequests(const QByteArray &data);
+    void parseDeclinedRequests(const QByteArray &data);
+    void parseRequestStatus(const QByteArray &data);
+    void parseBranchPackage(const QString &project, const QString &package, const QByteArray &data);
+    void parseLinkPackage(const QString &project, const QString &package, const QByteArray &data);
+    void parseCopyPackage(const QString &project, const QString &package, const QByteArray &data);
+    void parseCreateRequest(const QByteArray &data);
+    void parseCreateRequestStatus(const QByteArray &data);
+    void parseCreateProject(const QString &project, const QByteArray &data);
+    void parseCreatePackage(const QString &package, const QString &project, const QByteArray &data);
+    void parseUploadFile(const QString &project, const QString &package, const QString &file, const QByteArray &data);
+    void parseDeleteProject(const QString &project, const QByteArray &data);
+    void parseDeletePackage(const QString &project, const QString &package, const QByteArray &data);
+    void parseDeleteFile(const QString &project, const QString &package, const QString &fileName, const QByteArray &data);
     int getRequestNumber();
-    void parseAbout(const QString &data);
-    void parsePerson(const QString &data);
-    void parseUpdatePerson(const QString &data);
-    void parseDistributions(const QString &data);
+    void parseAbout(const QByteArray &data);
+    void parsePerson(const QByteArray &data);
+    void parseUpdatePerson(const QByteArray &data);
+    void parseDistributions(const QByteArray &data);
 
 private:
     static OBSXmlReader *instance;
-    OBSXmlReader();
-    void parseStatus(QXmlStreamReader &xml, OBSStatus *obsStatus);
     int row;
-    void parseRevision(QXmlStreamReader &xml, OBSRevision *obsRevision);
-    void parseRevisionList(const QString &data);
-    QList<QString> requestIdList;
-    QList<QString> oldRequestIdList;
-    void parseCollection(QXmlStreamReader &xml);
-    OBSRequest *parseRequest(QXmlStreamReader &xml);
-    QStringList parseList(QXmlStreamReader &xml);
-    void parseMetaConfig(QXmlStreamReader &xml, OBSMetaConfig *metaConfig);
-    QHash<QString, bool> parseRepositoryFlags(QXmlStreamReader &xml);
-    OBSDistribution *parseDistribution(QXmlStreamReader &xml);
-    QString requestNumber;
+    void parseRevisionList(const QByteArray &data);
+    void parseRequestCollection(const QByteArray &data, void (OBSXmlReader::*requestParsed)(OBSRequest *),
+                                void (OBSXmlReader::*listParsed)());
+    int requestNumber;
 
 signals:
     void finishedParsingPackage(OBSStatus*, int);
@@ -105,6 +117,7 @@ signals:
     void finishedParsingCreatePrjStatus(OBSStatus*);
     void finishedParsingCreatePkgStatus(OBSStatus*);
     void finishedParsingUploadFileRevision(OBSRevision*);
+    void finishedParsingCommitRevision(OBSRevision *revision);
     void finishedParsingDeletePrjStatus(OBSStatus*);
     void finishedParsingDeletePkgStatus(OBSStatus*);
     void finishedParsingDeleteFileStatus(OBSStatus*);
@@ -117,14 +130,18 @@ signals:
     void finishedParsingOutgoingRequestList();
     void finishedParsingDeclinedRequest(OBSRequest *request);
     void finishedParsingDeclinedRequestList();
+    void requestCountFetched(int count);
     void finishedParsingList(QStringList);
     void finishedParsingProjectList(QStringList);
-    void projectFetched(const QString &project);
+    void projectListChunkFetched(const QStringList &projects, bool first);
     void finishedParsingProjectMetaConfig(OBSPrjMetaConfig *prjMetaConfig);
     void finishedParsingPackageMetaConfig(OBSPkgMetaConfig *pkgMetaConfig);
-    void finishedParsingPackageList(QStringList);
+    void packageListChunkFetched(const QStringList &packages, const QString &project, bool first);
+    void finishedParsingPackageList(const QStringList &packageList, const QString &project);
     void finishedParsingFile(OBSFile*);
     void finishedParsingFileList();
+    void finishedParsingBinaryList(const QString &project, const QString &repository, const QString &arch,
+                                   const QString &package, const QList<OBSFile> &binaries);
     void finishedParsingLink(OBSLink *obsLink);
     void finishedParsingRequestStatus(OBSStatus *obsStatus);
     void finishedParsingAbout(OBSAbout *obsAbout);
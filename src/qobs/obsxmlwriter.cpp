@@ -207,6 +207,27 @@ QByteArray OBSXmlWriter::createLink(const QString &project, const QString &packa
     return data;
 }
 
+QByteArray OBSXmlWriter::createFileList(const QHash<QString, QString> &files) const
+{
+    QByteArray data;
+    QXmlStreamWriter xmlWriter(&data);
+    xmlWriter.setAutoFormatting(true);
+
+    QStringList names = files.keys();
+    names.sort();
+
+    xmlWriter.writeStartElement("directory");
+    for (const QString &name : names) {
+        xmlWriter.writeStartElement("entry");
+        xmlWriter.writeAttribute("name", name);
+        xmlWriter.writeAttribute("md5", files.value(name));
+        xmlWriter.writeEndElement(); // entry
+    }
+    xmlWriter.writeEndElement(); // directory
+
+    return data;
+}
+
 QByteArray OBSXmlWriter::createPerson(OBSPerson *obsPerson)
 {
     QByteArray data;
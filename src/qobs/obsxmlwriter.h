@@ -39,6 +39,7 @@ public:
     QByteArray createPackageMeta(OBSPkgMetaConfig *pkgMetaConfig) const;
     QByteArray createLink(const QString &project, const QString &package) const;
     QByteArray createPerson(OBSPerson *obsPerson);
+    QByteArray createFileList(const QHash<QString, QString> &files) const;
 
 private:
     void createRepositoryElement(QXmlStreamWriter &xmlWriter, OBSRepository *repository) const;